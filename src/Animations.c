@@ -185,7 +185,7 @@ static int anims_count;
 static cc_bool anims_validated, useLavaAnim, useWaterAnim, alwaysLavaAnim, alwaysWaterAnim;
 #define ANIM_MIN_ARGS 7
 
-static void Animations_ReadDescription(struct Stream* stream, const cc_string* path) {
+static void Animations_ReadDescription(struct Stream* stream, const cc_string* path, struct Bitmap* decoded) {
 	cc_string line; char lineBuffer[STRING_SIZE * 2];
 	cc_string parts[ANIM_MIN_ARGS];
 	int count;
@@ -351,8 +351,8 @@ static void Animations_Tick(struct ScheduledTask* task) {
 /*########################################################################################################################*
 *--------------------------------------------------Animations component---------------------------------------------------*
 *#########################################################################################################################*/
-static void AnimationsPngProcess(struct Stream* stream, const cc_string* name) {
-	cc_result res = Png_Decode(&anims_bmp, stream);
+static void AnimationsPngProcess(struct Stream* stream, const cc_string* name, struct Bitmap* decoded) {
+	cc_result res = TextureEntry_DecodePng(&anims_bmp, stream, decoded);
 	if (!res) return;
 
 	Logger_SysWarn2(res, "decoding", name);
@@ -362,13 +362,13 @@ static void AnimationsPngProcess(struct Stream* stream, const cc_string* name) {
 static struct TextureEntry animations_entry = { "animations.png", AnimationsPngProcess };
 static struct TextureEntry animations_txt   = { "animations.txt", Animations_ReadDescription };
 
-static void UseWaterProcess(struct Stream* stream, const cc_string* name) {
+static void UseWaterProcess(struct Stream* stream, const cc_string* name, struct Bitmap* decoded) {
 	useWaterAnim    = true;
 	alwaysWaterAnim = true;
 }
 static struct TextureEntry water_entry = { "usewateranim", UseWaterProcess };
 
-static void UseLavaProcess(struct Stream* stream, const cc_string* name) {
+static void UseLavaProcess(struct Stream* stream, const cc_string* name, struct Bitmap* decoded) {
 	useLavaAnim    = true;
 	alwaysLavaAnim = true;
 }
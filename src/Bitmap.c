@@ -85,8 +85,102 @@ cc_bool Png_Detect(const cc_uint8* data, cc_uint32 len) {
 	return len >= PNG_SIG_SIZE && Mem_Equal(data, pngSig, PNG_SIG_SIZE);
 }
 
+#if defined __x86_64__ || defined _M_X64
+/* SSE2 is always available on x86-64 */
+#include <emmintrin.h>
+#define PNG_USE_SSE2
+
+/* Reads/Writes a 3 or 4 byte pixel from/to the lowest bytes of a vector */
+static CC_INLINE __m128i Png_LoadPixel(const cc_uint8* src, int bpp) {
+	cc_uint32 v = src[0] | (src[1] << 8) | (src[2] << 16);
+	if (bpp == 4) v |= (cc_uint32)src[3] << 24;
+	return _mm_cvtsi32_si128((int)v);
+}
+
+static CC_INLINE void Png_StorePixel(cc_uint8* dst, __m128i value, int bpp) {
+	cc_uint32 v = (cc_uint32)_mm_cvtsi128_si32(value);
+	dst[0] = (cc_uint8)v; dst[1] = (cc_uint8)(v >> 8); dst[2] = (cc_uint8)(v >> 16);
+	if (bpp == 4) dst[3] = (cc_uint8)(v >> 24);
+}
+
+#define Png_Select(mask, a, b) _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b))
+#define Png_Abs16(x) _mm_max_epi16(x, _mm_sub_epi16(zero, x))
+
+/* Sub/Average/Paeth depend on the previous pixel, so can only be done a pixel at a time. */
+/* However, all the bytes of a 3 or 4 byte pixel (i.e. RGB/RGBA images) can be done at once */
+/* Up has no such dependency, so is done 16 bytes at a time for any pixel size */
+/* Returns false if the scanline must be reconstructed using the generic code instead */
+static cc_bool Png_ReconstructSSE2(cc_uint8 type, int bpp, cc_uint8* line, const cc_uint8* prior, cc_uint32 lineLen) {
+	__m128i zero = _mm_setzero_si128();
+	__m128i a, b, c, d, pa, pb, pc, smallest, nearest;
+	cc_uint32 i;
+
+	if (type == PNG_FILTER_UP) {
+		for (i = 0; i + 16 <= lineLen; i += 16) {
+			a = _mm_loadu_si128((const __m128i*)(line  + i));
+			b = _mm_loadu_si128((const __m128i*)(prior + i));
+			_mm_storeu_si128((__m128i*)(line + i), _mm_add_epi8(a, b));
+		}
+		for (; i < lineLen; i++) { line[i] += prior[i]; }
+		return true;
+	}
+	if (bpp != 3 && bpp != 4) return false;
+
+	switch (type) {
+	case PNG_FILTER_SUB:
+		a = zero;
+		for (i = 0; i < lineLen; i += bpp) {
+			a = _mm_add_epi8(Png_LoadPixel(line + i, bpp), a);
+			Png_StorePixel(line + i, a, bpp);
+		}
+		return true;
+
+	case PNG_FILTER_AVERAGE:
+		a = zero;
+		for (i = 0; i < lineLen; i += bpp) {
+			b = Png_LoadPixel(prior + i, bpp);
+			/* _mm_avg_epu8 rounds up, whereas the average here needs to be rounded down */
+			c = _mm_avg_epu8(a, b);
+			c = _mm_sub_epi8(c, _mm_and_si128(_mm_xor_si128(a, b), _mm_set1_epi8(1)));
+
+			a = _mm_add_epi8(Png_LoadPixel(line + i, bpp), c);
+			Png_StorePixel(line + i, a, bpp);
+		}
+		return true;
+
+	case PNG_FILTER_PAETH:
+		/* Bytes are widened to 16 bits, since the predictor needs signed differences */
+		a = zero; c = zero;
+		for (i = 0; i < lineLen; i += bpp) {
+			b = _mm_unpacklo_epi8(Png_LoadPixel(prior + i, bpp), zero);
+			d = _mm_unpacklo_epi8(Png_LoadPixel(line  + i, bpp), zero);
+
+			pa = _mm_sub_epi16(b, c);   /* p - a = b - c */
+			pb = _mm_sub_epi16(a, c);   /* p - b = a - c */
+			pc = _mm_add_epi16(pa, pb); /* p - c */
+			pa = Png_Abs16(pa); pb = Png_Abs16(pb); pc = Png_Abs16(pc);
+			smallest = _mm_min_epi16(pc, _mm_min_epi16(pa, pb));
+
+			/* Ties prefer a, then b, then c */
+			nearest = Png_Select(_mm_cmpeq_epi16(smallest, pb), b, c);
+			nearest = Png_Select(_mm_cmpeq_epi16(smallest, pa), a, nearest);
+
+			a = _mm_and_si128(_mm_add_epi16(d, nearest), _mm_set1_epi16(0xFF));
+			c = b;
+			Png_StorePixel(line + i, _mm_packus_epi16(a, a), bpp);
+		}
+		return true;
+	}
+	return false;
+}
+#endif
+
 static void Png_Reconstruct(cc_uint8 type, cc_uint8 bytesPerPixel, cc_uint8* line, cc_uint8* prior, cc_uint32 lineLen) {
 	cc_uint32 i, j;
+#ifdef PNG_USE_SSE2
+	if (Png_ReconstructSSE2(type, bytesPerPixel, line, prior, lineLen)) return;
+#endif
+
 	switch (type) {
 	case PNG_FILTER_NONE:
 		return;
@@ -113,16 +207,17 @@ static void Png_Reconstruct(cc_uint8 type, cc_uint8 bytesPerPixel, cc_uint8* lin
 		return;
 
 	case PNG_FILTER_PAETH:
-		/* TODO: verify this is right */
 		for (i = 0; i < bytesPerPixel; i++) {
 			line[i] += prior[i];
 		}
 		for (j = 0; i < lineLen; i++, j++) {
 			cc_uint8 a = line[j], b = prior[i], c = prior[j];
-			int p = a + b - c;
-			int pa = Math_AbsI(p - a);
-			int pb = Math_AbsI(p - b);
-			int pc = Math_AbsI(p - c);
+			/* p = a + b - c, so p - a = b - c, p - b = a - c */
+			int pa = b - c, pb = a - c, pc = pa + pb;
+			/* Avoid calling Math_AbsI, since this is done for every byte */
+			if (pa < 0) pa = -pa;
+			if (pb < 0) pb = -pb;
+			if (pc < 0) pc = -pc;
 
 			if (pa <= pb && pa <= pc) { line[i] += a; } 
 			else if (pb <= pc) {        line[i] += b; } 
@@ -252,6 +347,24 @@ static void Png_Expand_GRAYSCALE_A_16(int width, BitmapCol* palette, cc_uint8* s
 
 static void Png_Expand_RGB_A_8(int width, BitmapCol* palette, cc_uint8* src, BitmapCol* dst) {
 	int i, j;
+#if !defined CC_BIG_ENDIAN && BITMAPCOLOR_R_SHIFT == 0 && BITMAPCOLOR_G_SHIFT == 8 && BITMAPCOLOR_B_SHIFT == 16
+	/* PNG RGBA byte order is already the same as BitmapCol byte order */
+	Mem_Copy(dst, src, width * 4);
+	return;
+#elif defined PNG_USE_SSE2 && BITMAPCOLOR_R_SHIFT == 16 && BITMAPCOLOR_G_SHIFT == 8 && BITMAPCOLOR_B_SHIFT == 0
+	/* Swap R and B around of 4 pixels at once */
+	__m128i rbMask = _mm_set1_epi32(0x00FF00FF), rb, ga;
+
+	for (i = 0; i < (width & ~0x3); i += 4) {
+		rb = _mm_loadu_si128((const __m128i*)(src + i * 4));
+		ga = _mm_andnot_si128(rbMask, rb);
+		rb = _mm_and_si128(rbMask, rb);
+		rb = _mm_or_si128(_mm_slli_epi32(rb, 16), _mm_srli_epi32(rb, 16));
+		_mm_storeu_si128((__m128i*)(dst + i), _mm_or_si128(rb, ga));
+	}
+	for (j = i * 4; i < width; i++, j += 4) { PNG_Do_RGB_A__8(i, j); }
+	return;
+#endif
 
 	for (i = 0, j = 0; i < (width & ~0x3); i += 4, j += 16) {
 		PNG_Do_RGB_A__8(i    , j    ); PNG_Do_RGB_A__8(i + 1, j + 4 );
@@ -636,15 +749,57 @@ static void Png_EncodeRow(const cc_uint8* cur, const cc_uint8* prior, cc_uint8*
 	best[0] = bestFilter;
 }
 
+static CC_INLINE int Png_AbsI8(int x) { x = (cc_int8)x; return x < 0 ? -x : x; }
+
+#define PNG_SAMPLE_STEP 8
+/* DEFLATE_LEVEL_FASTEST only compresses runs, which works poorly for textured scenes */
+#define PNG_FAST_LEVEL 2
+
+/* Same as Png_EncodeRow, except that the filter is chosen by estimating from only */
+/*  every PNG_SAMPLE_STEP'th pixel, and so the line only has to be filtered once */
+static void Png_EncodeRowFast(const cc_uint8* cur, const cc_uint8* prior, cc_uint8* best, int lineLen, cc_bool alpha) {
+	int sub = 0, up = 0, avg = 0, paeth = 0;
+	int bpp = alpha ? 4 : 3;
+	int i, j, a, b, c, pa, pb, pc;
+	int bestFilter, bestEstimate;
+
+	for (i = bpp; i < lineLen; i += bpp * PNG_SAMPLE_STEP) {
+		for (j = i; j < i + bpp; j++) {
+			a = cur[j - bpp]; b = prior[j]; c = prior[j - bpp];
+
+			sub += Png_AbsI8(cur[j] - a);
+			up  += Png_AbsI8(cur[j] - b);
+			avg += Png_AbsI8(cur[j] - ((a + b) >> 1));
+
+			pa = b - c; pb = a - c; pc = pa + pb;
+			pa = pa < 0 ? -pa : pa;
+			pb = pb < 0 ? -pb : pb;
+			pc = pc < 0 ? -pc : pc;
+
+			if (pa <= pb && pa <= pc) { paeth += Png_AbsI8(cur[j] - a); }
+			else if (pb <= pc)        { paeth += Png_AbsI8(cur[j] - b); }
+			else                      { paeth += Png_AbsI8(cur[j] - c); }
+		}
+	}
+
+	/* Later filters win ties, same as in Png_EncodeRow */
+	bestFilter = PNG_FILTER_PAETH; bestEstimate = paeth;
+	if (avg < bestEstimate) { bestFilter = PNG_FILTER_AVERAGE; bestEstimate = avg; }
+	if (up  < bestEstimate) { bestFilter = PNG_FILTER_UP;      bestEstimate = up;  }
+	if (sub < bestEstimate) { bestFilter = PNG_FILTER_SUB; }
+
+	Png_Filter(bestFilter, cur, prior, best + 1, lineLen, bpp);
+	best[0] = bestFilter;
+}
+
 static BitmapCol* DefaultGetRow(struct Bitmap* bmp, int y) { return Bitmap_GetRow(bmp, y); }
-cc_result Png_Encode(struct Bitmap* bmp, struct Stream* stream, 
-					Png_RowGetter getRow, cc_bool alpha) {
+static cc_result Png_EncodeImage(struct Bitmap* bmp, struct Stream* stream, Png_RowGetter getRow, 
+								cc_bool alpha, cc_bool fast, cc_uint8* lines, void* zlState) {
 	cc_uint8 tmp[32];
-	/* TODO: This should be * 4 for alpha (should switch to mem_alloc though) */
-	cc_uint8 prevLine[PNG_MAX_DIMS * 3], curLine[PNG_MAX_DIMS * 3];
-	cc_uint8 bestLine[PNG_MAX_DIMS * 3 + 1];
+	cc_uint8* prevLine;
+	cc_uint8* curLine;
+	cc_uint8* bestLine;
 
-	struct ZLibState zlState;
 	struct Stream chunk, zlStream;
 	cc_uint32 stream_end, stream_beg;
 	int y, lineSize;
@@ -677,8 +832,16 @@ cc_result Png_Encode(struct Bitmap* bmp, struct Stream* stream,
 	Stream_SetU32_BE(&tmp[0], PNG_FourCC('I','D','A','T'));
 	if ((res = Stream_Write(&chunk, tmp, 4))) return res;
 
-	ZLib_MakeStream(&zlStream, &zlState, &chunk); 
+	if (fast) {
+		ZLib_MakeParallelStream(&zlStream, (struct GZipParallelState*)zlState, &chunk, PNG_FAST_LEVEL);
+	} else {
+		ZLib_MakeStream(&zlStream, (struct ZLibState*)zlState, &chunk);
+	}
+
 	lineSize = bmp->width * (alpha ? 4 : 3);
+	prevLine = lines;
+	curLine  = lines + lineSize;
+	bestLine = lines + lineSize * 2;
 	Mem_Set(prevLine, 0, lineSize);
 
 	for (y = 0; y < bmp->height; y++) {
@@ -687,10 +850,17 @@ cc_result Png_Encode(struct Bitmap* bmp, struct Stream* stream,
 		cc_uint8* cur  = (y & 1) == 0 ? curLine  : prevLine;
 
 		Png_MakeRow(src, cur, lineSize, alpha);
-		Png_EncodeRow(cur, prev, bestLine, lineSize, alpha);
+		if (fast) {
+			Png_EncodeRowFast(cur, prev, bestLine, lineSize, alpha);
+		} else {
+			Png_EncodeRow(cur, prev, bestLine, lineSize, alpha);
+		}
 
 		/* +1 for filter byte */
-		if ((res = Stream_Write(&zlStream, bestLine, lineSize + 1))) return res;
+		if ((res = Stream_Write(&zlStream, bestLine, lineSize + 1))) {
+			if (fast) GZip_FreeParallelStream((struct GZipParallelState*)zlState);
+			return res;
+		}
 	}
 	if ((res = zlStream.Close(&zlStream))) return res;
 	Stream_SetU32_BE(&tmp[0], chunk.Meta.CRC32.CRC32 ^ 0xFFFFFFFFUL);
@@ -710,3 +880,34 @@ cc_result Png_Encode(struct Bitmap* bmp, struct Stream* stream,
 	if ((res = Stream_Write(stream, tmp, 4))) return res;
 	return stream->Seek(stream, stream_end);
 }
+
+static cc_result Png_EncodeWith(struct Bitmap* bmp, struct Stream* stream, 
+								Png_RowGetter getRow, cc_bool alpha, cc_bool fast) {
+	/* Previous line, current line, then best filtered line (+1 for filter byte) */
+	int lineSize = bmp->width * (alpha ? 4 : 3);
+	cc_uint8* lines;
+	void* zlState;
+	cc_result res;
+
+	lines = (cc_uint8*)Mem_TryAlloc(lineSize * 3 + 1, 1);
+	if (!lines) return ERR_OUT_OF_MEMORY;
+
+	/* Compression state is too large to go on the stack of a worker thread */
+	zlState = Mem_TryAlloc(1, fast ? sizeof(struct GZipParallelState) : sizeof(struct ZLibState));
+	if (!zlState) { Mem_Free(lines); return ERR_OUT_OF_MEMORY; }
+
+	res = Png_EncodeImage(bmp, stream, getRow, alpha, fast, lines, zlState);
+	Mem_Free(zlState);
+	Mem_Free(lines);
+	return res;
+}
+
+cc_result Png_Encode(struct Bitmap* bmp, struct Stream* stream, 
+					Png_RowGetter getRow, cc_bool alpha) {
+	return Png_EncodeWith(bmp, stream, getRow, alpha, false);
+}
+
+cc_result Png_EncodeFast(struct Bitmap* bmp, struct Stream* stream, 
+						Png_RowGetter getRow, cc_bool alpha) {
+	return Png_EncodeWith(bmp, stream, getRow, alpha, true);
+}
@@ -101,4 +101,9 @@ CC_API cc_result Png_Decode(struct Bitmap* bmp, struct Stream* stream);
 /* if alpha is non-zero, RGBA channels are saved, otherwise only RGB channels are. */
 cc_result Png_Encode(struct Bitmap* bmp, struct Stream* stream, 
 						Png_RowGetter getRow, cc_bool alpha);
+/* Encodes a bitmap in PNG format, favouring speed over compression ratio. (e.g. for screenshots) */
+/* Filters are chosen from a sample of each row, and rows are compressed on multiple threads. */
+/* NOTE: The output is usually somewhat larger than from Png_Encode. */
+cc_result Png_EncodeFast(struct Bitmap* bmp, struct Stream* stream, 
+						Png_RowGetter getRow, cc_bool alpha);
 #endif
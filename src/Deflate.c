@@ -162,10 +162,13 @@ enum INFLATE_STATE_ {
 #define Inflate_NextBlockState(state) (state->LastBlock ? INFLATE_STATE_DONE : INFLATE_STATE_HEADER)
 /* Goes to the next state, after having finished reading a compressed entry */
 #define Inflate_NextCompressState(state) ((state->AvailIn >= INFLATE_FASTINF_IN && state->AvailOut >= INFLATE_FASTINF_OUT) ? INFLATE_STATE_FASTCOMPRESSED : INFLATE_STATE_COMPRESSED_LIT)
-/* The maximum amount of bytes that can be output is 258 */
-#define INFLATE_FASTINF_OUT 258
-/* The most input bytes required for huffman codes and extra data is 16 + 5 + 16 + 13 bits. Add 3 extra bytes to account for putting data into the bit buffer. */
-#define INFLATE_FASTINF_IN 10
+/* The maximum amount of bytes that can be output is 258, but matches are copied 8 bytes at a time */
+#define INFLATE_FASTINF_OUT (258 + 8)
+/* The most input bits required for huffman codes and extra data is 15 + 5 + 15 + 13 bits, */
+/*  which always fits in the bit buffer after reading in up to 8 bytes */
+#define INFLATE_FASTINF_IN 8
+#define INFLATE_FAST_MASK ((1 << INFLATE_FAST_BITS) - 1)
+
 
 static cc_uint32 Huffman_ReverseBits(cc_uint32 n, cc_uint8 bits) {
 	n = ((n & 0xAAAA) >> 1) | ((n & 0x5555) << 1);
@@ -178,7 +181,7 @@ static cc_uint32 Huffman_ReverseBits(cc_uint32 n, cc_uint8 bits) {
 /* Builds a huffman tree, based on input lengths of each codeword */
 static cc_result Huffman_Build(struct HuffmanTable* table, const cc_uint8* bitLens, int count) {
 	int bl_count[INFLATE_MAX_BITS], bl_offsets[INFLATE_MAX_BITS];
-	int code, offset, value;
+	int code, offset, value, codeword;
 	int i, j;
 
 	/* Initialise 'zero bit length' codewords */
@@ -237,19 +240,18 @@ static cc_result Huffman_Build(struct HuffmanTable* table, const cc_uint8* bitLe
 
 		/* Compute the accelerated lookup table values for this codeword.
 		* For example, assume len = 4 and codeword = 0100
-		* - Shift it left to be 0100_00000
-		* - Then, for all the indices from 0100_00000 to 0100_11111,
-		*   - bit reverse index, as huffman codes are read backwards
+		* - Bit reverse codeword to be 0010, as huffman codes are read backwards
+		* - Then, for all the indices from 00000_0010 to 11111_0010,
 		*   - set fast value to specify a 'value' value, and to skip 'len' bits
+		*   - the upper bits of the index are the bits that follow the codeword
 		*/
 		if (len <= INFLATE_FAST_BITS) {
 			cc_int16 packed = (cc_int16)((len << INFLATE_FAST_BITS) | value);
-			int codeword = table->FirstCodewords[len] + (bl_offsets[len] - table->FirstOffsets[len]);
-			codeword <<= (INFLATE_FAST_BITS - len);
+			codeword = table->FirstCodewords[len] + (bl_offsets[len] - table->FirstOffsets[len]);
+			codeword = Huffman_ReverseBits(codeword, len);
 
-			for (j = 0; j < 1 << (INFLATE_FAST_BITS - len); j++, codeword++) {
-				int index = Huffman_ReverseBits(codeword, INFLATE_FAST_BITS);
-				table->Fast[index] = packed;
+			for (j = 0; j < 1 << (INFLATE_FAST_BITS - len); j++) {
+				table->Fast[codeword | (j << len)] = packed;
 			}
 		}
 		bl_offsets[len]++;
@@ -296,44 +298,25 @@ static int Huffman_Decode(struct InflateState* state, struct HuffmanTable* table
 	return -1;
 }
 
-/* Inline the common <= 9 bits case */
-#define Huffman_UNSAFE_Decode(state, table, result) \
-{\
-	Inflate_UNSAFE_EnsureBits(state, INFLATE_MAX_BITS);\
-	packed = table.Fast[Inflate_PeekBits(state, INFLATE_FAST_BITS)];\
-	if (packed >= 0) {\
-		consumedBits = packed >> INFLATE_FAST_BITS;\
-		Inflate_ConsumeBits(state, consumedBits);\
-		result = packed & 0x1FF;\
-	} else {\
-		result = Huffman_UNSAFE_Decode_Slow(state, &table);\
-	}\
-}
-
-static int Huffman_UNSAFE_Decode_Slow(struct InflateState* state, struct HuffmanTable* table) {
-	cc_uint32 i, j, codeword;
+/* Decodes a codeword that is longer than INFLATE_FAST_BITS, from the bits at the start of the bit buffer */
+/* Returns the value and sets len to the length of the codeword, or returns -1 if the codeword is invalid */
+static int Huffman_DecodeLong(struct HuffmanTable* table, cc_uint32 bits, int* len) {
+	cc_uint32 i, codeword;
 	int offset;
 
 	/* Slow, bit by bit lookup. Need to reverse order for huffman. */
-	codeword = Inflate_PeekBits(state,       INFLATE_FAST_BITS);
-	codeword = Huffman_ReverseBits(codeword, INFLATE_FAST_BITS);
+	codeword = Huffman_ReverseBits(bits & INFLATE_FAST_MASK, INFLATE_FAST_BITS);
 
-	for (i = INFLATE_FAST_BITS + 1, j = INFLATE_FAST_BITS; i < INFLATE_MAX_BITS; i++, j++) {
-		codeword = (codeword << 1) | ((state->Bits >> j) & 1);
+	for (i = INFLATE_FAST_BITS + 1; i < INFLATE_MAX_BITS; i++) {
+		codeword = (codeword << 1) | ((bits >> (i - 1)) & 1);
 
 		if (codeword < table->EndCodewords[i]) {
 			offset = table->FirstOffsets[i] + (codeword - table->FirstCodewords[i]);
-			Inflate_ConsumeBits(state, i);
+			*len   = i;
 			return table->Values[offset];
 		}
 	}
-
-	Inflate_Fail(state, INF_ERR_INVALID_CODE);
-	/* Need to exit the fast decode loop */
-	/* TODO: This means a few garbage bytes can get written */
-	/* to the output, but it probably doesn't matter */
-	state->AvailIn = 0;
-	return 0;
+	return -1;
 }
 
 void Inflate_Init2(struct InflateState* state, struct Stream* source) {
@@ -389,84 +372,138 @@ static const cc_uint8 codelens_order[INFLATE_MAX_CODELENS] = {
 	16,17,18,0,8,7,9,6,10,5,11,4,12,3,13,2,14,1,15 
 };
 
-static void Inflate_InflateFast(struct InflateState* s) {
-	/* huffman variables */
-	cc_uint32 lit, len, dist;
-	cc_uint32 bits, lenIdx, distIdx;
-	int packed, consumedBits;
-
-	/* window variables */
-	cc_uint8* window;
-	cc_uint32 i, curIdx, startIdx;
-	cc_uint32 copyStart, copyLen, partLen;
+/* Copies 8 bytes at once. Source and destination can be unaligned, but must not overlap */
+#if defined __GNUC__
+#define Inflate_Copy8(dst, src) __builtin_memcpy(dst, src, 8)
+#elif defined _MSC_VER && (defined _M_IX86 || defined _M_X64 || defined _M_ARM64)
+#define Inflate_Copy8(dst, src) *((cc_uint64*)(dst)) = *((const cc_uint64*)(src))
+#else
+#define Inflate_Copy8(dst, src) { int k; for (k = 0; k < 8; k++) { (dst)[k] = ((const cc_uint8*)(src))[k]; } }
+#endif
+
+/* Fills up the bit buffer to at least 56 bits, reading at most 8 bytes */
+#if defined __GNUC__ && defined __BYTE_ORDER__ && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+/* Read 8 bytes at once, but only advance by the number of whole bytes that fit */
+#define Inflate_Refill(bits, numBits, in) \
+	{ cc_uint64 next; __builtin_memcpy(&next, in, 8); bits |= next << numBits; in += (63 - numBits) >> 3; numBits |= 56; }
+#else
+#define Inflate_Refill(bits, numBits, in) \
+	while (numBits <= 56) { bits |= (cc_uint64)(*in++) << numBits; numBits += 8; }
+#endif
+
+/* Decodes compressed data directly into the output, for as long as there is */
+/*  enough input and output space that neither needs to be checked per symbol */
+/* NOTE: outStart is the start of the output that has not been copied into the window yet */
+static void Inflate_InflateFast(struct InflateState* s, cc_uint8* outStart) {
+	struct HuffmanTable* lits  = &s->Table.Lits;
+	struct HuffmanTable* dists = &s->TableDists;
+	cc_uint8* in     = s->NextIn;
+	cc_uint8* inEnd  = s->NextIn + s->AvailIn;
+	cc_uint8* out    = s->Output;
+	cc_uint8* outEnd = s->Output + s->AvailOut;
+	cc_uint64 bits   = s->Bits;
+	cc_uint32 numBits = s->NumBits;
+
+	cc_uint32 len, dist, extra, i;
+	cc_uint64 repeated;
+	cc_uint8* src;
+	int packed, value, codeLen;
+
+	while (inEnd - in >= INFLATE_FASTINF_IN && outEnd - out >= INFLATE_FASTINF_OUT) {
+		/* Bit buffer then has enough bits for a whole length and distance pair */
+		Inflate_Refill(bits, numBits, in);
+
+		packed = lits->Fast[bits & INFLATE_FAST_MASK];
+		if (packed >= 0) {
+			codeLen = packed >> INFLATE_FAST_BITS;
+			value   = packed & 0x1FF;
+		} else {
+			value = Huffman_DecodeLong(lits, (cc_uint32)bits, &codeLen);
+			if (value < 0) { Inflate_Fail(s, INF_ERR_INVALID_CODE); break; }
+		}
+		bits >>= codeLen; numBits -= codeLen;
 
-	window = s->Window;
-	curIdx = s->WindowIndex;
-	copyStart = s->WindowIndex;
-	copyLen   = 0;
+		if (value < 256) { *out++ = (cc_uint8)value; continue; }
+		if (value == 256) { s->State = Inflate_NextBlockState(s); break; }
 
-#define INFLATE_FAST_COPY_MAX (INFLATE_WINDOW_SIZE - INFLATE_FASTINF_OUT)
-	while (s->AvailOut >= INFLATE_FASTINF_OUT && s->AvailIn >= INFLATE_FASTINF_IN && copyLen < INFLATE_FAST_COPY_MAX) {
-		Huffman_UNSAFE_Decode(s, s->Table.Lits, lit);
+		extra = len_bits[value - 257];
+		len   = len_base[value - 257] + (cc_uint32)(bits & ((1 << extra) - 1));
+		bits >>= extra; numBits -= extra;
 
-		if (lit <= 256) {
-			if (lit < 256) {
-				window[curIdx] = (cc_uint8)lit;
-				s->AvailOut--; copyLen++;
-				curIdx = (curIdx + 1) & INFLATE_WINDOW_MASK;
-			} else {
-				s->State = Inflate_NextBlockState(s);
-				break;
-			}
+		packed = dists->Fast[bits & INFLATE_FAST_MASK];
+		if (packed >= 0) {
+			codeLen = packed >> INFLATE_FAST_BITS;
+			value   = packed & 0x1FF;
 		} else {
-			lenIdx = lit - 257;
-			bits = len_bits[lenIdx];
-			Inflate_UNSAFE_EnsureBits(s, bits);
-			len  = len_base[lenIdx] + Inflate_ReadBits(s, bits);
-
-			Huffman_UNSAFE_Decode(s, s->TableDists, distIdx);
-			bits = dist_bits[distIdx];
-			Inflate_UNSAFE_EnsureBits(s, bits);
-			dist = dist_base[distIdx] + Inflate_ReadBits(s, bits);
-	
-			/* Window infinitely repeats like ...xyz|uvwxyz|uvwxyz|uvw... */
-			/* If start and end don't cross a boundary, can avoid masking index */
-			startIdx = (curIdx - dist) & INFLATE_WINDOW_MASK;
-			if (curIdx >= startIdx && (curIdx + len) < INFLATE_WINDOW_SIZE) {
-				cc_uint8* src = &window[startIdx]; 
-				cc_uint8* dst = &window[curIdx];
-
-				for (i = 0; i < (len & ~0x3); i += 4) {
-					*dst++ = *src++; *dst++ = *src++; *dst++ = *src++; *dst++ = *src++;
-				}
-				for (; i < len; i++) { *dst++ = *src++; }
-			} else {
-				for (i = 0; i < len; i++) {
-					window[(curIdx + i) & INFLATE_WINDOW_MASK] = window[(startIdx + i) & INFLATE_WINDOW_MASK];
-				}
-			}
-			curIdx = (curIdx + len) & INFLATE_WINDOW_MASK;
-			s->AvailOut -= len; copyLen += len;
+			value = Huffman_DecodeLong(dists, (cc_uint32)bits, &codeLen);
+			if (value < 0) { Inflate_Fail(s, INF_ERR_INVALID_CODE); break; }
 		}
+		bits >>= codeLen; numBits -= codeLen;
+
+		extra = dist_bits[value];
+		dist  = dist_base[value] + (cc_uint32)(bits & ((1 << extra) - 1));
+		bits >>= extra; numBits -= extra;
+
+		src = out - dist;
+		if (dist > (cc_uint32)(out - outStart)) {
+			/* Start of the match is in earlier output, which is only in the window now */
+			extra = dist - (cc_uint32)(out - outStart);
+			value = (int)((s->WindowIndex - extra) & INFLATE_WINDOW_MASK);
+			extra = min(extra, len);
+
+			for (i = 0; i < extra; i++) { out[i] = s->Window[(value + i) & INFLATE_WINDOW_MASK]; }
+			for (; i < len; i++)        { out[i] = src[i]; }
+		} else if (dist >= 8) {
+			/* Copying 8 bytes at a time may write past the end of the match, */
+			/*  but those bytes will get overwritten by later output anyways */
+			for (i = 0; i < len; i += 8) { Inflate_Copy8(out + i, src + i); }
+		} else if (dist == 1) {
+			/* Runs of the same byte are especially common */
+			repeated = src[0];
+			repeated |= repeated << 8; repeated |= repeated << 16; repeated |= repeated << 32;
+			for (i = 0; i < len; i += 8) { Inflate_Copy8(out + i, &repeated); }
+		} else {
+			for (i = 0; i < len; i++) { out[i] = src[i]; }
+		}
+		out += len;
 	}
 
-	s->WindowIndex = curIdx;
-	if (!copyLen) return;
+	/* Bit buffer of the slow path only holds 32 bits, so give whole bytes that were read ahead back */
+	/* NOTE: Bytes read before this call may no longer be in Input, so only those read since can be */
+	extra = min(numBits >> 3, (cc_uint32)(in - s->NextIn));
+	in -= extra; numBits -= extra * 8;
+
+	/* Refilling may leave some bits beyond numBits set, but the slow path expects those to be 0 */
+	s->Bits    = (cc_uint32)(bits & (((cc_uint64)1 << numBits) - 1));
+	s->NumBits = numBits;
+	s->AvailIn -= (cc_uint32)(in - s->NextIn);
+	s->NextIn   = in;
+	s->AvailOut -= (cc_uint32)(out - s->Output);
+	s->Output    = out;
+}
+
+/* Copies the output since data into the window, so that later output can refer back to it */
+static void Inflate_UpdateWindow(struct InflateState* s, cc_uint8* data) {
+	cc_uint32 len = (cc_uint32)(s->Output - data);
+	cc_uint32 partLen;
 
-	if (copyStart + copyLen < INFLATE_WINDOW_SIZE) {
-		Mem_Copy(s->Output, &s->Window[copyStart], copyLen);
-		s->Output += copyLen;
+	/* Only the most recent data needs to be kept */
+	if (len >= INFLATE_WINDOW_SIZE) {
+		Mem_Copy(s->Window, data + (len - INFLATE_WINDOW_SIZE), INFLATE_WINDOW_SIZE);
+		s->WindowIndex = 0;
 	} else {
-		partLen = INFLATE_WINDOW_SIZE - copyStart;
-		Mem_Copy(s->Output, &s->Window[copyStart], partLen);
-		s->Output += partLen;
-		Mem_Copy(s->Output, s->Window, copyLen - partLen);
-		s->Output += (copyLen - partLen);
+		partLen = INFLATE_WINDOW_SIZE - s->WindowIndex;
+		partLen = min(partLen, len);
+		Mem_Copy(&s->Window[s->WindowIndex], data, partLen);
+		/* Wrap around remainder of copy to start from beginning of window */
+		Mem_Copy(s->Window, data + partLen, len - partLen);
+		s->WindowIndex = (s->WindowIndex + len) & INFLATE_WINDOW_MASK;
 	}
 }
 
-void Inflate_Process(struct InflateState* s) {
-	cc_uint32 len, dist, nlen;
+/* NOTE: outStart is the start of the output that has not been copied into the window yet */
+static void Inflate_Decode(struct InflateState* s, cc_uint8* outStart) {
+	cc_uint32 len, dist, nlen, avail;
 	cc_uint32 i, bits;
 	cc_uint32 blockHeader;
 	cc_result res;
@@ -477,9 +514,7 @@ void Inflate_Process(struct InflateState* s) {
 	/* code lens table variables */
 	cc_uint32 count, repeatCount;
 	cc_uint8  repeatValue;
-	/* window variables */
-	cc_uint32 startIdx, curIdx;
-	cc_uint32 copyLen, windowCopyLen;
+	cc_uint32 copyLen;
 
 	for (;;) {
 		switch (s->State) {
@@ -527,10 +562,7 @@ void Inflate_Process(struct InflateState* s) {
 		case INFLATE_STATE_UNCOMPRESSED_DATA: {
 			/* read bits left in bit buffer (slow way) */
 			while (s->NumBits && s->AvailOut && s->Index) {
-				*s->Output = Inflate_ReadBits(s, 8);
-				s->Window[s->WindowIndex] = *s->Output;
-
-				s->WindowIndex = (s->WindowIndex + 1) & INFLATE_WINDOW_MASK;
+				*s->Output = (cc_uint8)Inflate_ReadBits(s, 8);
 				s->Output++; s->AvailOut--;	s->Index--;
 			}
 			if (!s->AvailIn || !s->AvailOut) return;
@@ -539,16 +571,6 @@ void Inflate_Process(struct InflateState* s) {
 			copyLen = min(copyLen, s->Index);
 			if (copyLen > 0) {
 				Mem_Copy(s->Output, s->NextIn, copyLen);
-				windowCopyLen = INFLATE_WINDOW_SIZE - s->WindowIndex;
-				windowCopyLen = min(windowCopyLen, copyLen);
-
-				Mem_Copy(&s->Window[s->WindowIndex], s->Output, windowCopyLen);
-				/* Wrap around remainder of copy to start from beginning of window */
-				if (windowCopyLen < copyLen) {
-					Mem_Copy(s->Window, &s->Output[windowCopyLen], copyLen - windowCopyLen);
-				}
-
-				s->WindowIndex = (s->WindowIndex + copyLen) & INFLATE_WINDOW_MASK;
 				s->Output += copyLen; s->AvailOut -= copyLen; s->Index -= copyLen;
 				s->NextIn += copyLen; s->AvailIn  -= copyLen;		
 			}
@@ -650,9 +672,7 @@ void Inflate_Process(struct InflateState* s) {
 			if (lit < 256) {
 				if (lit == -1) return;
 				*s->Output = (cc_uint8)lit;
-				s->Window[s->WindowIndex] = (cc_uint8)lit;
 				s->Output++; s->AvailOut--;
-				s->WindowIndex = (s->WindowIndex + 1) & INFLATE_WINDOW_MASK;
 				break;
 			} else if (lit == 256) {
 				s->State = Inflate_NextBlockState(s);
@@ -690,17 +710,14 @@ void Inflate_Process(struct InflateState* s) {
 			len = s->TmpLit; dist = s->TmpDist;
 			len = min(len, s->AvailOut);
 
-			/* TODO: Should we test outside of the loop, whether a masking will be required or not? */		
-			startIdx = (s->WindowIndex - dist) & INFLATE_WINDOW_MASK;
-			curIdx   = s->WindowIndex;
 			for (i = 0; i < len; i++) {
-				cc_uint8 value = s->Window[(startIdx + i) & INFLATE_WINDOW_MASK];
-				*s->Output = value;
-				s->Window[(curIdx + i) & INFLATE_WINDOW_MASK] = value;
+				/* Earlier output might only be in the window now */
+				avail = (cc_uint32)(s->Output - outStart);
+				*s->Output = dist <= avail ? *(s->Output - dist) :
+					s->Window[(s->WindowIndex - (dist - avail)) & INFLATE_WINDOW_MASK];
 				s->Output++;
 			}
 
-			s->WindowIndex = (curIdx + len) & INFLATE_WINDOW_MASK;
 			s->TmpLit   -= len;
 			s->AvailOut -= len;
 			if (!s->TmpLit) { s->State = Inflate_NextCompressState(s); }
@@ -708,7 +725,7 @@ void Inflate_Process(struct InflateState* s) {
 		}
 
 		case INFLATE_STATE_FASTCOMPRESSED: {
-			Inflate_InflateFast(s);
+			Inflate_InflateFast(s, outStart);
 			if (s->State == INFLATE_STATE_FASTCOMPRESSED) {
 				s->State = Inflate_NextCompressState(s);
 			}
@@ -721,13 +738,19 @@ void Inflate_Process(struct InflateState* s) {
 	}
 }
 
+void Inflate_Process(struct InflateState* s) {
+	cc_uint8* outStart = s->Output;
+	Inflate_Decode(s, outStart);
+	Inflate_UpdateWindow(s, outStart);
+}
+
 static cc_result Inflate_StreamRead(struct Stream* stream, cc_uint8* data, cc_uint32 count, cc_uint32* modified) {
 	struct InflateState* state;
 	cc_uint8* inputEnd;
 	cc_uint32 read, left;
 	cc_uint32 startAvailOut;
 	cc_bool hasInput;
-	cc_result res;
+	cc_result res = 0;
 
 	*modified = 0;
 	state = (struct InflateState*)stream->Meta.Inflate;
@@ -736,7 +759,7 @@ static cc_result Inflate_StreamRead(struct Stream* stream, cc_uint8* data, cc_ui
 
 	hasInput = true;
 	while (state->AvailOut > 0 && hasInput) {
-		if (state->State == INFLATE_STATE_DONE) return state->result;
+		if (state->State == INFLATE_STATE_DONE) { res = state->result; break; }
 
 		if (!state->AvailIn) {
 			/* Fully used up input buffer. Cycle back to start. */
@@ -745,7 +768,7 @@ static cc_result Inflate_StreamRead(struct Stream* stream, cc_uint8* data, cc_ui
 
 			left = (cc_uint32)(inputEnd - state->NextIn);
 			res  = state->Source->Read(state->Source, state->NextIn, left, &read);
-			if (res) return res;
+			if (res) break;
 
 			/* Did we fail to read in more input data? Can't immediately return here, */
 			/* because there might be a few bits of data left in the bit buffer */
@@ -755,10 +778,13 @@ static cc_result Inflate_StreamRead(struct Stream* stream, cc_uint8* data, cc_ui
 		
 		/* Reading data reduces available out */
 		startAvailOut = state->AvailOut;
-		Inflate_Process(state);
+		/* Decompress directly into the destination, and only update the window at the end */
+		Inflate_Decode(state, data);
 		*modified += (startAvailOut - state->AvailOut);
 	}
-	return 0;
+
+	Inflate_UpdateWindow(state, data);
+	return res;
 }
 
 void Inflate_MakeStream2(struct Stream* stream, struct InflateState* state, struct Stream* underlying) {
@@ -788,8 +814,6 @@ static const cc_uint16 deflate_dist[31] = {
 #define Deflate_PushBits(state, value, bits) state->Bits |= (value) << state->NumBits; state->NumBits += (bits);
 /* Pushes bits of the huffman codeword bits for the given literal, but does not write them */
 #define Deflate_PushLit(state, value) Deflate_PushBits(state, state->LitsCodewords[value], state->LitsLens[value])
-/* Pushes given bits (reversing for huffman code), but does not write them */
-#define Deflate_PushHuff(state, value, bits) Deflate_PushBits(state, Huffman_ReverseBits(value, bits), bits)
 /* Writes given byte to output */
 #define Deflate_WriteByte(state) *state->NextOut++ = state->Bits; state->AvailOut--; state->Bits >>= 8; state->NumBits -= 8;
 /* Flushes bits in buffer to output buffer */
@@ -797,6 +821,37 @@ static const cc_uint16 deflate_dist[31] = {
 
 #define MIN_MATCH_LEN 3
 #define MAX_MATCH_LEN 258
+#define DEFLATE_TOO_FAR 4096
+
+#ifdef CC_BUILD_LOWMEM
+#define DEFLATE_WINDOW_SIZE 16384
+#define DEFLATE_HASH_BITS 12
+#else
+#define DEFLATE_WINDOW_SIZE 32768
+#define DEFLATE_HASH_BITS 15
+#endif
+#define DEFLATE_INPUT_SIZE (DEFLATE_WINDOW_SIZE + DEFLATE_BLOCK_SIZE)
+
+/* Match finding and block state, which is too large to fit in the public DeflateState */
+/* Allocated by Deflate_MakeStream2, and freed by Deflate_FreeTables */
+struct DeflateTables {
+	int Level; /* Compression level, see DEFLATE_LEVEL_ */
+	cc_uint16 DistsCodewords[INFLATE_MAX_DISTS];
+	cc_uint8 DistsLens[INFLATE_MAX_DISTS];
+	cc_uint16 LitsFreqs[INFLATE_MAX_LITS];   /* Number of times each value occurs in current block */
+	cc_uint16 DistsFreqs[INFLATE_MAX_DISTS];
+
+	cc_uint8 Input[DEFLATE_INPUT_SIZE];
+	cc_uint16 Head[1UL << DEFLATE_HASH_BITS];
+	cc_uint16 Prev[DEFLATE_INPUT_SIZE];
+	/* NOTE: The largest possible value that can get */
+	/*  stored in Head/Prev is <= DEFLATE_INPUT_SIZE */
+
+	/* Symbols of the current block. Distance of 0 means a literal, otherwise length is match length - 3 */
+	cc_uint16 SymDists[DEFLATE_BLOCK_SIZE];
+	cc_uint8 SymLens[DEFLATE_BLOCK_SIZE];
+	int NumSyms;
+};
 
 /* Number of bytes that match (are the same) from a and b */
 static int Deflate_MatchLen(cc_uint8* a, cc_uint8* b, int maxLen) {
@@ -807,7 +862,79 @@ static int Deflate_MatchLen(cc_uint8* a, cc_uint8* b, int maxLen) {
 
 /* Hashes 3 bytes of data */
 static cc_uint32 Deflate_Hash(cc_uint8* src) {
-	return (cc_uint32)((src[0] << 8) ^ (src[1] << 4) ^ (src[2])) & DEFLATE_HASH_MASK;
+	cc_uint32 value = (src[0] << 16) | (src[1] << 8) | src[2];
+	return (cc_uint32)(value * 2654435761UL) >> (32 - DEFLATE_HASH_BITS);
+}
+
+/* Inserts the data at the given position into the hash chain */
+static void Deflate_Insert(struct DeflateTables* t, cc_uint32 hash, int pos) {
+	t->Prev[pos]  = t->Head[hash];
+	t->Head[hash] = pos;
+}
+
+/* Describes how much effort is spent finding matches for a compression level */
+struct DeflateLevel {
+	cc_uint16 MaxChain;  /* Maximum number of previous matches to explore */
+	cc_uint16 NiceLen;   /* Stop looking for longer matches once a match is this long */
+	cc_uint16 MaxInsert; /* Insert every byte of matches up to this long into the hash chains */
+	cc_bool Lazy;        /* Whether to check if a longer match starts at the next byte */
+};
+static const struct DeflateLevel deflate_levels[DEFLATE_LEVEL_BEST + 1] = {
+	/* chain nice insert lazy */
+	{    0,   0,   0, false }, /* 0 - stored blocks only */
+	{    0,   0,   0, false }, /* 1 - runs of same byte only */
+	{    4,  16,   4, false },
+	{    8,  32,   8, false },
+	{    4,  64,  16, true  },
+	{    5, 258,  32, true  }, /* 5 - default */
+	{   16, 128, 258, true  },
+	{   32, 258, 258, true  },
+	{   64, 258, 258, true  },
+	{  256, 258, 258, true  }  /* 9 - smallest output */
+};
+
+/* Constructs a huffman encoding table (for values to codewords) */
+static void Deflate_BuildTable(const cc_uint8* lens, int count, cc_uint16* codewords, cc_uint8* bitlens) {
+	int i, j, offset, codeword;
+	struct HuffmanTable table;
+
+	/* NOTE: Can ignore since lens table is not user controlled */
+	(void)Huffman_Build(&table, lens, count);
+	for (i = 0; i < INFLATE_MAX_BITS; i++) {
+		if (!table.EndCodewords[i]) continue;
+		count = table.EndCodewords[i] - table.FirstCodewords[i];
+
+		for (j = 0; j < count; j++) {
+			offset   = table.Values[table.FirstOffsets[i] + j];
+			codeword = table.FirstCodewords[i] + j;
+			bitlens[offset]   = i;
+			codewords[offset] = Huffman_ReverseBits(codeword, i);
+		}
+	}
+}
+
+/* Number of literal/length and distance codes that can actually be used in compressed data */
+#define DEFLATE_NUM_LITS  286
+#define DEFLATE_NUM_DISTS 30
+/* Maximum bit length of a literal/length or distance codeword */
+#define DEFLATE_MAX_BITS 15
+/* Maximum bit length of a codeword bit length codeword */
+#define DEFLATE_MAX_CODELEN_BITS 7
+/* Number of extra bits for codeword bit length repeat codes 16, 17, 18 */
+static const cc_uint8 codelens_bits[3] = { 2, 3, 7 };
+
+/* Returns index of the length code for the given match length */
+static int Deflate_LenCode(int len) {
+	int j;
+	for (j = 0; len >= deflate_len[j + 1]; j++);
+	return j;
+}
+
+/* Returns index of the distance code for the given match distance */
+static int Deflate_DistCode(int dist) {
+	int j;
+	for (j = 0; dist >= deflate_dist[j + 1]; j++);
+	return j;
 }
 
 /* Writes a literal to state->Output */
@@ -817,138 +944,465 @@ static void Deflate_Lit(struct DeflateState* state, int lit) {
 }
 
 /* Writes a length-distance pair to state->Output */
-static void Deflate_LenDist(struct DeflateState* state, int len, int dist) {
+static void Deflate_LenDist(struct DeflateState* state, struct DeflateTables* t, int len, int dist) {
 	int j;
 	/* TODO: Do we actually need the if (len_bits[j]) ????????? does writing 0 bits matter??? */
 
-	for (j = 0; len >= deflate_len[j + 1]; j++);
+	j = Deflate_LenCode(len);
 	Deflate_PushLit(state, j + 257);
 	if (len_bits[j]) { Deflate_PushBits(state, len - deflate_len[j], len_bits[j]); }
 	Deflate_FlushBits(state);
 
-	for (j = 0; dist >= deflate_dist[j + 1]; j++);
-	Deflate_PushHuff(state, j, 5);
+	/* Distance codeword and extra bits may not fit in bit buffer together */
+	j = Deflate_DistCode(dist);
+	Deflate_PushBits(state, t->DistsCodewords[j], t->DistsLens[j]);
+	Deflate_FlushBits(state);
 	if (dist_bits[j]) { Deflate_PushBits(state, dist - deflate_dist[j], dist_bits[j]); }
 	Deflate_FlushBits(state);
 }
 
-/* Moves "current block" to "previous block", adjusting state if needed. */
-static void Deflate_MoveBlock(struct DeflateState* state) {
-	int i;
-	Mem_Copy(state->Input, state->Input + DEFLATE_BLOCK_SIZE, DEFLATE_BLOCK_SIZE);
-	state->InputPosition = DEFLATE_BLOCK_SIZE;
+/* Writes all buffered output data to the destination stream */
+static cc_result Deflate_WriteOutput(struct DeflateState* state) {
+	cc_result res = Stream_Write(state->Dest, state->Output, DEFLATE_OUT_SIZE - state->AvailOut);
+	state->NextOut  = state->Output;
+	state->AvailOut = DEFLATE_OUT_SIZE;
+	return res;
+}
+
+/* Writes buffered output data to the destination stream, if output buffer is nearly full */
+static cc_result Deflate_CheckOutput(struct DeflateState* state) {
+	/* leave room for a few bytes and literals at end */
+	if (state->AvailOut >= 20) return 0;
+	return Deflate_WriteOutput(state);
+}
+
+/* Slides the window forward by a block, so "current block" becomes the end of the window */
+static void Deflate_MoveBlock(struct DeflateState* state, struct DeflateTables* t) {
+	int i, prev;
+	/* Copy in block sized pieces, so source and destination never overlap */
+	for (i = 0; i < DEFLATE_WINDOW_SIZE; i += DEFLATE_BLOCK_SIZE) {
+		Mem_Copy(t->Input + i, t->Input + i + DEFLATE_BLOCK_SIZE, DEFLATE_BLOCK_SIZE);
+	}
+	state->InputPosition = DEFLATE_WINDOW_SIZE;
 
 	/* adjust hash table offsets, removing offsets that are no longer in data at all */
-	for (i = 0; i < Array_Elems(state->Head); i++) {
-		state->Head[i] = state->Head[i] < DEFLATE_BLOCK_SIZE ? 0 : (state->Head[i] - DEFLATE_BLOCK_SIZE);
+	for (i = 0; i < Array_Elems(t->Head); i++) {
+		t->Head[i] = t->Head[i] < DEFLATE_BLOCK_SIZE ? 0 : (t->Head[i] - DEFLATE_BLOCK_SIZE);
 	}
-	for (i = 0; i < Array_Elems(state->Prev); i++) {
-		state->Prev[i] = state->Prev[i] < DEFLATE_BLOCK_SIZE ? 0 : (state->Prev[i] - DEFLATE_BLOCK_SIZE);
+	/* hash chain links are indexed by position too, so also need to be moved */
+	for (i = 0; i < DEFLATE_WINDOW_SIZE; i++) {
+		prev = t->Prev[i + DEFLATE_BLOCK_SIZE];
+		t->Prev[i] = prev < DEFLATE_BLOCK_SIZE ? 0 : (prev - DEFLATE_BLOCK_SIZE);
 	}
 }
 
-/* Compresses current block of data */
-static cc_result Deflate_FlushBlock(struct DeflateState* state, int len) {
-	cc_uint32 hash, nextHash;
-	int bestLen, maxLen, matchLen, depth;
-	int bestPos, pos, nextPos;
-	cc_uint16 oldHead;
-	cc_uint8* input;
-	cc_uint8* cur;
-	cc_result res;
+/* Adds a literal to the symbols of the current block */
+static void Deflate_AddLit(struct DeflateTables* t, int lit) {
+	t->SymDists[t->NumSyms] = 0;
+	t->SymLens[t->NumSyms]  = (cc_uint8)lit;
+	t->NumSyms++;
+	t->LitsFreqs[lit]++;
+}
+
+/* Adds a length-distance pair to the symbols of the current block */
+static void Deflate_AddLenDist(struct DeflateTables* t, int len, int dist) {
+	t->SymDists[t->NumSyms] = (cc_uint16)dist;
+	t->SymLens[t->NumSyms]  = (cc_uint8)(len - MIN_MATCH_LEN);
+	t->NumSyms++;
+	t->LitsFreqs[Deflate_LenCode(len) + 257]++;
+	t->DistsFreqs[Deflate_DistCode(dist)]++;
+}
 
-	if (!state->WroteHeader) {
-		state->WroteHeader = true;
-		Deflate_PushBits(state, 3, 3); /* final block TRUE, block type FIXED */
+/* Searches the hash chain starting at pos for a match of the data at cur that is longer than bestLen */
+/* Returns position of the longest such match, or 0 if there is none */
+static int Deflate_LongestMatch(struct DeflateTables* t, const struct DeflateLevel* level,
+								cc_uint8* cur, int pos, int maxLen, int* bestLen) {
+	cc_uint8* input = t->Input;
+	int curPos  = (int)(cur - input);
+	int niceLen = min(level->NiceLen, maxLen);
+	int bestPos = 0, matchLen, depth;
+	if (*bestLen >= maxLen) return 0;
+
+	for (depth = 0; pos != 0 && depth < level->MaxChain; depth++) {
+		if (curPos - pos > DEFLATE_WINDOW_SIZE) break;
+
+		/* Can quickly skip matches that can't be longer than the longest match so far */
+		if (input[pos + *bestLen] == cur[*bestLen]) {
+			matchLen = Deflate_MatchLen(&input[pos], cur, maxLen);
+			if (matchLen > *bestLen) {
+				*bestLen = matchLen; bestPos = pos;
+				if (matchLen >= niceLen) break;
+			}
+		}
+		pos = t->Prev[pos];
 	}
+	return bestPos;
+}
+
+/* Finds matches in the current block of data, and converts it into literals and length-distance pairs */
+static void Deflate_FindMatches(struct DeflateTables* t, int len) {
+	const struct DeflateLevel* level = &deflate_levels[t->Level];
+	int bestLen, maxLen, nextLen;
+	int bestPos, pos, i;
+	cc_uint32 hash;
+	cc_uint8* input;
+	cc_uint8* cur;
 
 	/* Based off descriptions from http://www.gzip.org/algorithm.txt and
 	https://github.com/nothings/stb/blob/master/stb_image_write.h */
-	input = state->Input;
-	cur   = input + DEFLATE_BLOCK_SIZE;
+	input = t->Input;
+	cur   = input + DEFLATE_WINDOW_SIZE;
 
 	/* Compress current block of data */
 	/* Use > instead of >=, because also try match at one byte after current */
 	while (len > MIN_MATCH_LEN) {
-		hash   = Deflate_Hash(cur);
-		maxLen = min(len, MAX_MATCH_LEN);
-
+		maxLen  = min(len, MAX_MATCH_LEN);
 		bestLen = MIN_MATCH_LEN - 1; /* Match must be at least 3 bytes */
 		bestPos = 0;
+		pos     = (int)(cur - input);
 
-		/* Find longest match starting at this byte */
-		/* Only explore up to 5 previous matches, to avoid slow performance */
-		/* (i.e prefer quickly saving maps/screenshots to completely optimal filesize) */
-		pos = state->Head[hash];
-		for (depth = 0; pos != 0 && depth < 5; depth++) {
-			matchLen = Deflate_MatchLen(&input[pos], cur, maxLen);
-			if (matchLen > bestLen) { bestLen = matchLen; bestPos = pos; }
-			pos = state->Prev[pos];
+		/* Runs of the same byte are very common in map data, so always check for one */
+		if (cur > input + DEFLATE_WINDOW_SIZE && cur[-1] == cur[0]) {
+			bestLen = Deflate_MatchLen(cur - 1, cur, maxLen);
+			bestPos = pos - 1;
 		}
 
-		/* Insert this entry into the hash chain */
-		pos = (int)(cur - input);
-		oldHead = state->Head[hash];
-		state->Head[hash] = pos;
-		state->Prev[pos]  = oldHead;
-
-		/* Lazy evaluation: Find longest match starting at next byte */
-		/* If that's longer than the longest match at current byte, throwaway this match */
-		if (bestPos) {
-			nextHash = Deflate_Hash(cur + 1);
-			nextPos  = state->Head[nextHash];
-			maxLen   = min(len - 1, MAX_MATCH_LEN);
-
-			for (depth = 0; nextPos != 0 && depth < 5; depth++) {
-				matchLen = Deflate_MatchLen(&input[nextPos], cur + 1, maxLen);
-				if (matchLen > bestLen) { bestPos = 0; break; }
-				nextPos = state->Prev[nextPos];
+		if (t->Level != DEFLATE_LEVEL_FASTEST) {
+			hash = Deflate_Hash(cur);
+			pos  = Deflate_LongestMatch(t, level, cur, t->Head[hash], maxLen, &bestLen);
+			if (pos) bestPos = pos;
+
+			pos = (int)(cur - input);
+			Deflate_Insert(t, hash, pos);
+
+			/* Lazy evaluation: Find longest match starting at next byte */
+			/* If that's longer than the longest match at current byte, throwaway this match */
+			if (bestPos && level->Lazy) {
+				hash    = Deflate_Hash(cur + 1);
+				maxLen  = min(len - 1, MAX_MATCH_LEN);
+				nextLen = bestLen;
+				if (Deflate_LongestMatch(t, level, cur + 1, t->Head[hash], maxLen, &nextLen)) bestPos = 0;
 			}
 		}
 
-		if (bestPos) {
-			Deflate_LenDist(state, bestLen, pos - bestPos);
+		/* Short matches far away usually take more bits than just writing literals */
+		if (bestLen == MIN_MATCH_LEN && pos - bestPos > DEFLATE_TOO_FAR) bestPos = 0;
+
+		if (bestPos && bestLen >= MIN_MATCH_LEN) {
+			Deflate_AddLenDist(t, bestLen, pos - bestPos);
+
+			/* Insert rest of the match too, so later data can find more matches */
+			if (bestLen <= level->MaxInsert) {
+				for (i = 1; i < bestLen && i + MIN_MATCH_LEN <= len; i++) {
+					Deflate_Insert(t, Deflate_Hash(cur + i), pos + i);
+				}
+			}
 			len -= bestLen; cur += bestLen;
 		} else {
-			Deflate_Lit(state, *cur);
+			Deflate_AddLit(t, *cur);
 			len--; cur++;
 		}
-
-		/* leave room for a few bytes and literals at end */
-		if (state->AvailOut >= 20) continue;
-		res = Stream_Write(state->Dest, state->Output, DEFLATE_OUT_SIZE - state->AvailOut);
-		state->NextOut  = state->Output;
-		state->AvailOut = DEFLATE_OUT_SIZE;
-		if (res) return res;
 	}
 
 	/* literals for last few bytes */
 	while (len > 0) {
-		Deflate_Lit(state, *cur);
+		Deflate_AddLit(t, *cur);
 		len--; cur++;
 	}
+}
 
-	res = Stream_Write(state->Dest, state->Output, DEFLATE_OUT_SIZE - state->AvailOut);
-	state->NextOut  = state->Output;
-	state->AvailOut = DEFLATE_OUT_SIZE;
+/* Calculates length limited huffman codeword bit lengths from how often each value occurs */
+static void Deflate_BuildLengths(const cc_uint16* freqs, int count, int maxBits, cc_uint8* lens) {
+	cc_uint16 values[INFLATE_MAX_LITS];
+	cc_uint32 weights[INFLATE_MAX_LITS * 2];
+	cc_uint16 parents[INFLATE_MAX_LITS * 2];
+	cc_uint8 depths[INFLATE_MAX_LITS * 2];
+	int bl_count[INFLATE_MAX_BITS];
+	int i, j, n, leaf, node, next, a, b;
+	cc_uint32 total;
+
+	/* Sort used values by ascending frequency */
+	Mem_Set(lens, 0, count);
+	for (i = 0, n = 0; i < count; i++) {
+		if (!freqs[i]) continue;
+
+		for (j = n; j > 0 && freqs[values[j - 1]] > freqs[i]; j--) {
+			values[j] = values[j - 1];
+		}
+		values[j] = i; n++;
+	}
 
-	Deflate_MoveBlock(state);
-	return res;
+	/* Always produce at least two codewords, so the huffman tree isn't degenerate */
+	if (n < 2) {
+		i = n ? values[0] : 0;
+		lens[i] = 1; lens[i ? 0 : 1] = 1;
+		return;
+	}
+
+	/* Build the huffman tree using two queues, as leaves are already sorted by weight: */
+	/* Leaves are 0 to n-1, and internal nodes n to 2n-2 get created in ascending weight order */
+	for (i = 0; i < n; i++) weights[i] = freqs[values[i]];
+	leaf = 0; node = n;
+
+	for (next = n; next < 2 * n - 1; next++) {
+		a = (leaf < n && (node == next || weights[leaf] <= weights[node])) ? leaf++ : node++;
+		b = (leaf < n && (node == next || weights[leaf] <= weights[node])) ? leaf++ : node++;
+		weights[next] = weights[a] + weights[b];
+		parents[a] = next; parents[b] = next;
+	}
+
+	/* Parents are always created after their children, so walk from root downwards */
+	depths[2 * n - 2] = 0;
+	for (i = 2 * n - 3; i >= 0; i--) {
+		depths[i] = depths[parents[i]] + 1;
+	}
+
+	for (i = 0; i <= maxBits; i++) bl_count[i] = 0;
+	for (i = 0; i < n; i++) {
+		bl_count[min(depths[i], maxBits)]++;
+	}
+
+	/* Clamping leaves to maxBits produces too many codewords. To fix this, repeatedly */
+	/*  remove a maxBits leaf and split a shorter leaf into two (same approach as miniz) */
+	total = 0;
+	for (i = maxBits; i > 0; i--) {
+		total += (cc_uint32)bl_count[i] << (maxBits - i);
+	}
+
+	while (total != (1UL << maxBits)) {
+		bl_count[maxBits]--;
+		for (i = maxBits - 1; i > 0; i--) {
+			if (!bl_count[i]) continue;
+			bl_count[i]--; bl_count[i + 1] += 2; break;
+		}
+		total--;
+	}
+
+	/* Most frequent values get the shortest codewords */
+	for (i = 1, j = n; i <= maxBits; i++) {
+		for (a = bl_count[i]; a > 0; a--) { lens[values[--j]] = i; }
+	}
+}
+
+/* Calculates number of bits needed to write the symbols of the current block using the given tables */
+static cc_uint32 Deflate_CalcCost(struct DeflateTables* t, const cc_uint8* litsLens, const cc_uint8* distsLens) {
+	cc_uint32 cost = 0;
+	int i;
+
+	for (i = 0; i < DEFLATE_NUM_LITS; i++) {
+		cost += t->LitsFreqs[i] * litsLens[i];
+	}
+	for (i = 0; i < DEFLATE_NUM_LITS - 257; i++) {
+		cost += t->LitsFreqs[i + 257] * len_bits[i];
+	}
+	for (i = 0; i < DEFLATE_NUM_DISTS; i++) {
+		cost += t->DistsFreqs[i] * (distsLens[i] + dist_bits[i]);
+	}
+	return cost;
+}
+
+/* Describes the huffman tables of a dynamic huffman compressed block */
+struct DeflateDynamic {
+	cc_uint8 LitsLens[INFLATE_MAX_LITS], DistsLens[INFLATE_MAX_DISTS];
+	cc_uint8 CodeLens[INFLATE_MAX_CODELENS];
+	int NumLits, NumDists, NumCodeLens;
+	/* Run length encoded literal/length and distance codeword bit lengths */
+	cc_uint8 Syms[INFLATE_MAX_LITS_DISTS], Extra[INFLATE_MAX_LITS_DISTS];
+	int NumSyms;
+};
+
+#define Deflate_AddCodeLen(d, sym, extra) d->Syms[d->NumSyms] = sym; d->Extra[d->NumSyms] = extra; d->NumSyms++;
+
+/* Calculates dynamic huffman tables for the current block, returning number of bits needed to write it */
+static cc_uint32 Deflate_BuildDynamic(struct DeflateTables* t, struct DeflateDynamic* d) {
+	cc_uint8 lens[INFLATE_MAX_LITS_DISTS];
+	cc_uint16 freqs[INFLATE_MAX_CODELENS];
+	int i, count, value, run, sym;
+	cc_uint32 cost;
+
+	Deflate_BuildLengths(t->LitsFreqs,  INFLATE_MAX_LITS,  DEFLATE_MAX_BITS, d->LitsLens);
+	Deflate_BuildLengths(t->DistsFreqs, INFLATE_MAX_DISTS, DEFLATE_MAX_BITS, d->DistsLens);
+
+	/* Trailing unused codewords don't need to be written */
+	for (d->NumLits  = DEFLATE_NUM_LITS;  d->NumLits  > 257 && !d->LitsLens[d->NumLits - 1];   d->NumLits--)  {}
+	for (d->NumDists = DEFLATE_NUM_DISTS; d->NumDists > 1   && !d->DistsLens[d->NumDists - 1]; d->NumDists--) {}
+
+	Mem_Copy(lens,               d->LitsLens,  d->NumLits);
+	Mem_Copy(lens + d->NumLits,  d->DistsLens, d->NumDists);
+	count = d->NumLits + d->NumDists;
+	d->NumSyms = 0;
+
+	/* Run length encode the codeword bit lengths */
+	for (i = 0; i < count; i += run) {
+		value = lens[i];
+		for (run = 1; i + run < count && lens[i + run] == value; run++) {}
+
+		if (value == 0 && run >= 3) {
+			run = min(run, 138);
+			if (run >= 11) {
+				Deflate_AddCodeLen(d, 18, run - 11);
+			} else {
+				Deflate_AddCodeLen(d, 17, run - 3);
+			}
+		} else if (i > 0 && lens[i - 1] == value && run >= 3) {
+			run = min(run, 6);
+			Deflate_AddCodeLen(d, 16, run - 3);
+		} else {
+			run = 1;
+			Deflate_AddCodeLen(d, value, 0);
+		}
+	}
+
+	Mem_Set(freqs, 0, sizeof(freqs));
+	for (i = 0; i < d->NumSyms; i++) { freqs[d->Syms[i]]++; }
+	Deflate_BuildLengths(freqs, INFLATE_MAX_CODELENS, DEFLATE_MAX_CODELEN_BITS, d->CodeLens);
+
+	for (d->NumCodeLens = INFLATE_MAX_CODELENS; d->NumCodeLens > 4; d->NumCodeLens--) {
+		if (d->CodeLens[codelens_order[d->NumCodeLens - 1]]) break;
+	}
+
+	cost = 5 + 5 + 4 + 3 * d->NumCodeLens;
+	for (i = 0; i < d->NumSyms; i++) {
+		sym   = d->Syms[i];
+		cost += d->CodeLens[sym];
+		if (sym >= 16) cost += codelens_bits[sym - 16];
+	}
+	return cost + Deflate_CalcCost(t, d->LitsLens, d->DistsLens);
+}
+
+/* Writes the huffman tables of a dynamic huffman compressed block */
+static cc_result Deflate_WriteDynamic(struct DeflateState* state, struct DeflateTables* t, struct DeflateDynamic* d) {
+	cc_uint16 codewords[INFLATE_MAX_CODELENS];
+	cc_uint8 bitlens[INFLATE_MAX_CODELENS];
+	int i, sym;
+	cc_result res;
+
+	Deflate_PushBits(state, d->NumLits  - 257, 5);
+	Deflate_PushBits(state, d->NumDists - 1,   5);
+	Deflate_PushBits(state, d->NumCodeLens - 4, 4);
+	Deflate_FlushBits(state);
+	if ((res = Deflate_CheckOutput(state))) return res;
+
+	for (i = 0; i < d->NumCodeLens; i++) {
+		Deflate_PushBits(state, d->CodeLens[codelens_order[i]], 3);
+		Deflate_FlushBits(state);
+	}
+	Deflate_BuildTable(d->CodeLens, INFLATE_MAX_CODELENS, codewords, bitlens);
+
+	for (i = 0; i < d->NumSyms; i++) {
+		if ((res = Deflate_CheckOutput(state))) return res;
+		sym = d->Syms[i];
+
+		Deflate_PushBits(state, codewords[sym], bitlens[sym]);
+		if (sym >= 16) { Deflate_PushBits(state, d->Extra[i], codelens_bits[sym - 16]); }
+		Deflate_FlushBits(state);
+	}
+
+	Deflate_BuildTable(d->LitsLens,  INFLATE_MAX_LITS,  state->LitsCodewords,  state->LitsLens);
+	Deflate_BuildTable(d->DistsLens, INFLATE_MAX_DISTS, t->DistsCodewords, t->DistsLens);
+	return 0;
+}
+
+/* Writes the symbols of the current block, followed by the end of block symbol */
+static cc_result Deflate_WriteSymbols(struct DeflateState* state, struct DeflateTables* t) {
+	int i, dist;
+	cc_result res;
+
+	for (i = 0; i < t->NumSyms; i++) {
+		if ((res = Deflate_CheckOutput(state))) return res;
+		dist = t->SymDists[i];
+
+		if (dist) {
+			Deflate_LenDist(state, t, t->SymLens[i] + MIN_MATCH_LEN, dist);
+		} else {
+			Deflate_Lit(state, t->SymLens[i]);
+		}
+	}
+
+	/* Write huffman encoded "literal 256" to terminate symbols */
+	Deflate_PushLit(state, 256);
+	Deflate_FlushBits(state);
+	return 0;
+}
+
+/* Writes the current block of data as-is */
+static cc_result Deflate_WriteStored(struct DeflateState* state, cc_uint8* data, int len) {
+	cc_result res;
+
+	/* Stored block data must start on a byte boundary */
+	Deflate_PushBits(state, 0, (8 - state->NumBits) & 7);
+	Deflate_FlushBits(state);
+	Deflate_PushBits(state, len, 16);
+	Deflate_FlushBits(state);
+	Deflate_PushBits(state, len ^ 0xFFFF, 16);
+	Deflate_FlushBits(state);
+
+	if ((res = Deflate_WriteOutput(state))) return res;
+	return Stream_Write(state->Dest, data, len);
+}
+
+/* Compresses current block of data, using whichever block type produces the smallest output */
+static cc_result Deflate_FlushBlock(struct DeflateState* state, struct DeflateTables* t, int len, cc_bool lastBlock) {
+	struct DeflateDynamic dynamic;
+	cc_uint32 storedCost, fixedCost = 0, dynamicCost = 0;
+	cc_bool stored = t->Level == DEFLATE_LEVEL_STORE;
+	cc_result res;
+
+	if (!stored) {
+		Mem_Set(t->LitsFreqs,  0, sizeof(t->LitsFreqs));
+		Mem_Set(t->DistsFreqs, 0, sizeof(t->DistsFreqs));
+		t->NumSyms = 0;
+
+		Deflate_FindMatches(t, len);
+		t->LitsFreqs[256] = 1; /* end of block symbol */
+
+		/* Block header is 3 bits, and stored blocks are then padded to a byte boundary */
+		storedCost  = 3 + ((8 - ((state->NumBits + 3) & 7)) & 7) + 32 + 8 * len;
+		fixedCost   = 3 + Deflate_CalcCost(t, fixed_lits, fixed_dists);
+		dynamicCost = 3 + Deflate_BuildDynamic(t, &dynamic);
+		stored      = storedCost <= fixedCost && storedCost <= dynamicCost;
+	}
+
+	if (stored) {
+		Deflate_PushBits(state, lastBlock, 3); /* block type STORED */
+		res = Deflate_WriteStored(state, t->Input + DEFLATE_WINDOW_SIZE, len);
+	} else if (dynamicCost < fixedCost) {
+		Deflate_PushBits(state, lastBlock | 4, 3); /* block type DYNAMIC */
+		res = Deflate_WriteDynamic(state, t, &dynamic);
+		if (!res) res = Deflate_WriteSymbols(state, t);
+	} else {
+		Deflate_PushBits(state, lastBlock | 2, 3); /* block type FIXED */
+		Deflate_BuildTable(fixed_lits,  INFLATE_MAX_LITS,  state->LitsCodewords, state->LitsLens);
+		Deflate_BuildTable(fixed_dists, INFLATE_MAX_DISTS, t->DistsCodewords,    t->DistsLens);
+		res = Deflate_WriteSymbols(state, t);
+	}
+	if (res) return res;
+
+	Deflate_MoveBlock(state, t);
+	return 0;
+}
+
+static void Deflate_FreeTables(struct Stream* stream) {
+	Mem_Free(stream->Meta.Deflate.Tables);
+	stream->Meta.Deflate.Tables = NULL;
 }
 
 /* Adds data to buffered output data, flushing if needed */
 static cc_result Deflate_StreamWrite(struct Stream* stream, const cc_uint8* data, cc_uint32 total, cc_uint32* modified) {
-	struct DeflateState* state;
+	struct DeflateState*  state;
+	struct DeflateTables* t;
 	cc_result res;
 
-	state = (struct DeflateState*)stream->Meta.Inflate;
+	state = (struct DeflateState*)stream->Meta.Deflate.State;
+	t     = (struct DeflateTables*)stream->Meta.Deflate.Tables;
 	*modified = 0;
+	if (!t) return ERR_OUT_OF_MEMORY;
 
 	while (total > 0) {
-		cc_uint8* dst = &state->Input[state->InputPosition];
+		cc_uint8* dst = &t->Input[state->InputPosition];
 		cc_uint32 len = total;
-		if (state->InputPosition + len >= DEFLATE_BUFFER_SIZE) {
-			len = DEFLATE_BUFFER_SIZE - state->InputPosition;
+		if (state->InputPosition + len >= DEFLATE_INPUT_SIZE) {
+			len = DEFLATE_INPUT_SIZE - state->InputPosition;
 		}
 
 		Mem_Copy(dst, data, len);
@@ -957,75 +1411,75 @@ static cc_result Deflate_StreamWrite(struct Stream* stream, const cc_uint8* data
 		*modified += len;
 		data += len;
 
-		if (state->InputPosition == DEFLATE_BUFFER_SIZE) {
-			res = Deflate_FlushBlock(state, DEFLATE_BLOCK_SIZE);
-			if (res) return res;
+		if (state->InputPosition == DEFLATE_INPUT_SIZE) {
+			res = Deflate_FlushBlock(state, t, DEFLATE_BLOCK_SIZE, false);
+			/* Stream is unusable after an error anyways, so callers don't need to Close it */
+			if (res) { Deflate_FreeTables(stream); return res; }
 		}
 	}
 	return 0;
 }
 
-/* Flushes any buffered data, then writes terminating symbol */
-static cc_result Deflate_StreamClose(struct Stream* stream) {
-	struct DeflateState* state;
+/* Flushes any buffered data. If not the last block, an empty stored block is then written, */
+/*  so that the output ends on a byte boundary and more DEFLATE blocks can be appended to it */
+static cc_result Deflate_Finish(struct DeflateState* state, struct DeflateTables* t, cc_bool lastBlock) {
 	cc_result res;
-
-	state = (struct DeflateState*)stream->Meta.Inflate;
-	res   = Deflate_FlushBlock(state, state->InputPosition - DEFLATE_BLOCK_SIZE);
+	res = Deflate_FlushBlock(state, t, state->InputPosition - DEFLATE_WINDOW_SIZE, lastBlock);
 	if (res) return res;
 
-	/* Write huffman encoded "literal 256" to terminate symbols */
-	Deflate_PushLit(state, 256);
-	Deflate_FlushBits(state);
+	if (!lastBlock) {
+		Deflate_PushBits(state, 0, 3); /* block type STORED */
+		if ((res = Deflate_WriteStored(state, NULL, 0))) return res;
+	}
 
 	/* In case last byte still has a few extra bits */
 	if (state->NumBits) {
 		while (state->NumBits < 8) { Deflate_PushBits(state, 0, 1); }
 		Deflate_FlushBits(state);
 	}
-
-	return Stream_Write(state->Dest, state->Output, DEFLATE_OUT_SIZE - state->AvailOut);
+	return Deflate_WriteOutput(state);
 }
 
-/* Constructs a huffman encoding table (for values to codewords) */
-static void Deflate_BuildTable(const cc_uint8* lens, int count, cc_uint16* codewords, cc_uint8* bitlens) {
-	int i, j, offset, codeword;
-	struct HuffmanTable table;
-
-	/* NOTE: Can ignore since lens table is not user controlled */
-	(void)Huffman_Build(&table, lens, count);
-	for (i = 0; i < INFLATE_MAX_BITS; i++) {
-		if (!table.EndCodewords[i]) continue;
-		count = table.EndCodewords[i] - table.FirstCodewords[i];
+/* Flushes any buffered data as the final block */
+static cc_result Deflate_StreamClose(struct Stream* stream) {
+	struct DeflateState*  state = (struct DeflateState*)stream->Meta.Deflate.State;
+	struct DeflateTables* t     = (struct DeflateTables*)stream->Meta.Deflate.Tables;
+	cc_result res;
 
-		for (j = 0; j < count; j++) {
-			offset   = table.Values[table.FirstOffsets[i] + j];
-			codeword = table.FirstCodewords[i] + j;
-			bitlens[offset]   = i;
-			codewords[offset] = Huffman_ReverseBits(codeword, i);
-		}
-	}
+	if (!t) return ERR_OUT_OF_MEMORY;
+	res = Deflate_Finish(state, t, true);
+	Deflate_FreeTables(stream);
+	return res;
 }
 
-void Deflate_MakeStream(struct Stream* stream, struct DeflateState* state, struct Stream* underlying) {
+void Deflate_MakeStream2(struct Stream* stream, struct DeflateState* state, struct Stream* underlying, int level) {
+	struct DeflateTables* t;
 	Stream_Init(stream);
-	stream->Meta.Inflate = state;
+	stream->Meta.Deflate.State = state;
 	stream->Write = Deflate_StreamWrite;
 	stream->Close = Deflate_StreamClose;
 
-	/* First half of buffer is "previous block" */
-	state->InputPosition = DEFLATE_BLOCK_SIZE;
+	/* Start of buffer is the window of previously compressed data */
+	state->InputPosition = DEFLATE_WINDOW_SIZE;
 	state->Bits    = 0;
 	state->NumBits = 0;
 
 	state->NextOut  = state->Output;
 	state->AvailOut = DEFLATE_OUT_SIZE;
 	state->Dest     = underlying;
-	state->WroteHeader = false;
 
-	Mem_Set(state->Head, 0, sizeof(state->Head));
-	Mem_Set(state->Prev, 0, sizeof(state->Prev));
-	Deflate_BuildTable(fixed_lits, INFLATE_MAX_LITS, state->LitsCodewords, state->LitsLens);
+	/* NOTE: If this fails, Write and Close return ERR_OUT_OF_MEMORY */
+	t = (struct DeflateTables*)Mem_TryAlloc(1, sizeof(struct DeflateTables));
+	stream->Meta.Deflate.Tables = t;
+	if (!t) return;
+
+	t->Level = (level >= 0 && level <= DEFLATE_LEVEL_BEST) ? level : DEFLATE_LEVEL_DEFAULT;
+	Mem_Set(t->Head, 0, sizeof(t->Head));
+	Mem_Set(t->Prev, 0, sizeof(t->Prev));
+}
+
+void Deflate_MakeStream(struct Stream* stream, struct DeflateState* state, struct Stream* underlying) {
+	Deflate_MakeStream2(stream, state, underlying, DEFLATE_LEVEL_DEFAULT);
 }
 
 
@@ -1045,15 +1499,8 @@ static cc_result GZip_StreamClose(struct Stream* stream) {
 
 static cc_result GZip_StreamWrite(struct Stream* stream, const cc_uint8* data, cc_uint32 count, cc_uint32* modified) {
 	struct GZipState* state = (struct GZipState*)stream->Meta.Inflate;
-	cc_uint32 i, crc32 = state->Crc32;
 	state->Size += count;
-
-	/* TODO: Optimise this calculation */
-	for (i = 0; i < count; i++) {
-		crc32 = Utils_Crc32Table[(crc32 ^ data[i]) & 0xFF] ^ (crc32 >> 8);
-	}
-
-	state->Crc32 = crc32;
+	state->Crc32 = Utils_UpdateCRC32(state->Crc32, data, count);
 	return Deflate_StreamWrite(stream, data, count, modified);
 }
 
@@ -1062,19 +1509,282 @@ static cc_result GZip_StreamWriteFirst(struct Stream* stream, const cc_uint8* da
 	struct GZipState* state = (struct GZipState*)stream->Meta.Inflate;
 	cc_result res;
 
-	if ((res = Stream_Write(state->Base.Dest, header, sizeof(header)))) return res;
+	if ((res = Stream_Write(state->Base.Dest, header, sizeof(header)))) {
+		Deflate_FreeTables(stream); return res;
+	}
 	stream->Write = GZip_StreamWrite;
 	return GZip_StreamWrite(stream, data, count, modified);
 }
 
-void GZip_MakeStream(struct Stream* stream, struct GZipState* state, struct Stream* underlying) {
-	Deflate_MakeStream(stream, &state->Base, underlying);
+void GZip_MakeStream2(struct Stream* stream, struct GZipState* state, struct Stream* underlying, int level) {
+	Deflate_MakeStream2(stream, &state->Base, underlying, level);
 	state->Crc32  = 0xFFFFFFFFUL;
 	state->Size   = 0;
 	stream->Write = GZip_StreamWriteFirst;
 	stream->Close = GZip_StreamClose;
 }
 
+void GZip_MakeStream(struct Stream* stream, struct GZipState* state, struct Stream* underlying) {
+	GZip_MakeStream2(stream, state, underlying, DEFLATE_LEVEL_DEFAULT);
+}
+
+
+/*########################################################################################################################*
+*--------------------------------------------Parallel GZip/ZLib (compress)-----------------------------------------------*
+*#########################################################################################################################*/
+/* Based off the approach used by pigz (https://zlib.net/pigz/) */
+/* Maximum size of a compressed chunk: one stored block per DEFLATE block, plus the empty stored block at the end */
+#define GZIP_PARALLEL_MAX_OUT (GZIP_PARALLEL_CHUNK_SIZE + 5 * (GZIP_PARALLEL_CHUNK_SIZE / DEFLATE_BLOCK_SIZE + 2) + 8)
+#define CRC32_POLY 0xEDB88320UL
+
+struct GZipParallelChunk { cc_uint32 Length, Size, Checksum; cc_result Result; cc_bool Last; };
+
+/* Multiplies two polynomials modulo the CRC32 polynomial */
+static cc_uint32 Crc32_MultModP(cc_uint32 a, cc_uint32 b) {
+	cc_uint32 m = 1UL << 31, p = 0;
+	for (;;) {
+		if (a & m) {
+			p ^= b;
+			if ((a & (m - 1)) == 0) break;
+		}
+		m >>= 1;
+		b = (b & 1) ? (b >> 1) ^ CRC32_POLY : b >> 1;
+	}
+	return p;
+}
+
+/* Calculates CRC32 of data A followed by data B, from CRC32 of data A and CRC32 of data B */
+/* Based off crc32_combine from zlib */
+static cc_uint32 Crc32_Combine(cc_uint32 crcA, cc_uint32 crcB, cc_uint32 lenB) {
+	cc_uint32 xp = 1UL << 23; /* x^8, i.e. one byte */
+	cc_uint32 p  = 1UL << 31; /* x^0 */
+
+	/* Calculate x^(8 * lenB) by repeated squaring */
+	for (; lenB; lenB >>= 1) {
+		if (lenB & 1) p = Crc32_MultModP(xp, p);
+		xp = Crc32_MultModP(xp, xp);
+	}
+	return Crc32_MultModP(p, crcA) ^ crcB;
+}
+
+#define ADLER32_BASE 65521
+/* Calculates Adler32 of data A followed by data B, from Adler32 of data A and Adler32 of data B */
+/* Based off adler32_combine from zlib */
+static cc_uint32 Adler32_Combine(cc_uint32 adlerA, cc_uint32 adlerB, cc_uint32 lenB) {
+	cc_uint32 rem  = lenB % ADLER32_BASE;
+	cc_uint32 sum1 = adlerA & 0xFFFF;
+	cc_uint32 sum2 = (rem * sum1) % ADLER32_BASE;
+
+	sum1 += (adlerB & 0xFFFF) + ADLER32_BASE - 1;
+	sum2 += (adlerA >> 16) + (adlerB >> 16) + ADLER32_BASE - rem;
+
+	if (sum1 >= ADLER32_BASE)       sum1 -= ADLER32_BASE;
+	if (sum1 >= ADLER32_BASE)       sum1 -= ADLER32_BASE;
+	if (sum2 >= ADLER32_BASE * 2UL) sum2 -= ADLER32_BASE * 2UL;
+	if (sum2 >= ADLER32_BASE)       sum2 -= ADLER32_BASE;
+	return sum1 | (sum2 << 16);
+}
+
+/* Makes the given data be the window of previous data, so that matches can reference it */
+static void Deflate_SetDictionary(struct DeflateTables* t, const cc_uint8* data, int len) {
+	cc_uint8* src = t->Input + DEFLATE_WINDOW_SIZE - len;
+	int pos;
+	Mem_Copy(src, data, len);
+
+	/* Last 2 positions can't be hashed yet, as their 3 bytes overlap with the data to compress */
+	/* NOTE: Position 0 is skipped, as that indicates end of a hash chain */
+	for (pos = DEFLATE_WINDOW_SIZE - len; pos < DEFLATE_WINDOW_SIZE - 2; pos++) {
+		if (pos) Deflate_Insert(t, Deflate_Hash(t->Input + pos), pos);
+	}
+}
+
+static cc_result GZipParallel_OutputWrite(struct Stream* s, const cc_uint8* data, cc_uint32 count, cc_uint32* modified) {
+	if (count > s->Meta.Mem.Left) return ERR_END_OF_STREAM;
+	Mem_Copy(s->Meta.Mem.Cur, data, count);
+
+	s->Meta.Mem.Cur  += count;
+	s->Meta.Mem.Left -= count;
+	*modified = count;
+	return 0;
+}
+
+/* Compresses a chunk of data into its own sequence of DEFLATE blocks */
+static void GZipParallel_Compress(void* obj, int i) {
+	struct GZipParallelState* state = (struct GZipParallelState*)obj;
+	struct GZipParallelChunk* chunk = &state->Chunks[i];
+	cc_uint8* data = state->Input + DEFLATE_WINDOW_SIZE + i * GZIP_PARALLEL_CHUNK_SIZE;
+	struct DeflateState* deflate;
+	struct DeflateTables* tables;
+	struct Stream stream, output;
+	cc_uint32 modified;
+
+	chunk->Size   = min(GZIP_PARALLEL_CHUNK_SIZE, state->InputLen - i * GZIP_PARALLEL_CHUNK_SIZE);
+	chunk->Length = 0;
+	chunk->Checksum = state->ZLib ? Utils_UpdateAdler32(1, data, chunk->Size) : Utils_CRC32(data, chunk->Size);
+
+	deflate = (struct DeflateState*)Mem_TryAlloc(1, sizeof(struct DeflateState));
+	if (!deflate) { chunk->Result = ERR_OUT_OF_MEMORY; return; }
+
+	Stream_Init(&output);
+	output.Write         = GZipParallel_OutputWrite;
+	output.Meta.Mem.Cur  = state->Output + i * GZIP_PARALLEL_MAX_OUT;
+	output.Meta.Mem.Left = GZIP_PARALLEL_MAX_OUT;
+
+	Deflate_MakeStream2(&stream, deflate, &output, state->Level);
+	tables = (struct DeflateTables*)stream.Meta.Deflate.Tables;
+	if (!tables) { chunk->Result = ERR_OUT_OF_MEMORY; Mem_Free(deflate); return; }
+	if (i || state->HasWindow) Deflate_SetDictionary(tables, data - DEFLATE_WINDOW_SIZE, DEFLATE_WINDOW_SIZE);
+
+	/* NOTE: Write frees the tables when it fails */
+	chunk->Result = Deflate_StreamWrite(&stream, data, chunk->Size, &modified);
+	if (!chunk->Result) {
+		chunk->Result = Deflate_Finish(deflate, tables, chunk->Last);
+		Deflate_FreeTables(&stream);
+	}
+
+	chunk->Length = GZIP_PARALLEL_MAX_OUT - output.Meta.Mem.Left;
+	Mem_Free(deflate);
+}
+
+/* Compresses all the chunks of data in the input buffer, then writes them in order */
+static cc_result GZipParallel_Flush(struct GZipParallelState* state) {
+	struct GZipParallelChunk* chunk;
+	int i, numChunks;
+	cc_result res;
+
+	/* The final chunk must still be compressed even if there's no data, as it contains the last block */
+	numChunks = state->InputLen ? (state->InputLen + GZIP_PARALLEL_CHUNK_SIZE - 1) / GZIP_PARALLEL_CHUNK_SIZE : 1;
+	for (i = 0; i < numChunks; i++) {
+		state->Chunks[i].Last = state->LastBatch && i == numChunks - 1;
+	}
+	Utils_ParallelFor(GZipParallel_Compress, state, numChunks);
+
+	for (i = 0; i < numChunks; i++) {
+		chunk = &state->Chunks[i];
+		if (chunk->Result) return chunk->Result;
+
+		res = Stream_Write(state->Dest, state->Output + i * GZIP_PARALLEL_MAX_OUT, chunk->Length);
+		if (res) return res;
+		if (state->ZLib) {
+			state->Checksum = Adler32_Combine(state->Checksum, chunk->Checksum, chunk->Size);
+		} else {
+			state->Checksum = Crc32_Combine(state->Checksum,   chunk->Checksum, chunk->Size);
+		}
+	}
+
+	/* Last part of this batch becomes the window for the next batch */
+	if (state->InputLen >= DEFLATE_WINDOW_SIZE) {
+		Mem_Copy(state->Input, state->Input + state->InputLen, DEFLATE_WINDOW_SIZE);
+		state->HasWindow = true;
+	}
+	state->InputLen = 0;
+	return 0;
+}
+
+static cc_result GZipParallel_StreamWrite(struct Stream* stream, const cc_uint8* data, cc_uint32 total, cc_uint32* modified) {
+	struct GZipParallelState* state = (struct GZipParallelState*)stream->Meta.Inflate;
+	cc_uint32 len;
+	cc_result res;
+	*modified = 0;
+
+	while (total > 0) {
+		len = min(total, GZIP_PARALLEL_CHUNKS * GZIP_PARALLEL_CHUNK_SIZE - state->InputLen);
+		Mem_Copy(state->Input + DEFLATE_WINDOW_SIZE + state->InputLen, data, len);
+
+		state->InputLen += len;
+		state->Size     += len;
+		*modified += len;
+		data      += len;
+		total     -= len;
+
+		if (state->InputLen == GZIP_PARALLEL_CHUNKS * GZIP_PARALLEL_CHUNK_SIZE) {
+			if ((res = GZipParallel_Flush(state))) return res;
+		}
+	}
+	return 0;
+}
+
+static cc_result GZipParallel_StreamWriteFirst(struct Stream* stream, const cc_uint8* data, cc_uint32 count, cc_uint32* modified) {
+	static cc_uint8 header[10]  = { 0x1F, 0x8B, 0x08 }; /* GZip header */
+	static cc_uint8 zlHeader[2] = { 0x78, 0x9C };       /* ZLib header */
+	struct GZipParallelState* state = (struct GZipParallelState*)stream->Meta.Inflate;
+	cc_result res;
+
+	if (!state->Input)  state->Input  = (cc_uint8*)Mem_TryAlloc(DEFLATE_WINDOW_SIZE + GZIP_PARALLEL_CHUNKS * GZIP_PARALLEL_CHUNK_SIZE, 1);
+	if (!state->Output) state->Output = (cc_uint8*)Mem_TryAlloc(GZIP_PARALLEL_CHUNKS, GZIP_PARALLEL_MAX_OUT);
+	if (!state->Chunks) state->Chunks = (struct GZipParallelChunk*)Mem_TryAlloc(GZIP_PARALLEL_CHUNKS, sizeof(struct GZipParallelChunk));
+	if (!state->Input || !state->Output || !state->Chunks) return ERR_OUT_OF_MEMORY;
+
+	if (state->ZLib) {
+		res = Stream_Write(state->Dest, zlHeader, sizeof(zlHeader));
+	} else {
+		res = Stream_Write(state->Dest, header,   sizeof(header));
+	}
+
+	if (res) return res;
+	stream->Write = GZipParallel_StreamWrite;
+	return GZipParallel_StreamWrite(stream, data, count, modified);
+}
+
+void GZip_FreeParallelStream(struct GZipParallelState* state) {
+	Mem_Free(state->Input);  state->Input  = NULL;
+	Mem_Free(state->Output); state->Output = NULL;
+	Mem_Free(state->Chunks); state->Chunks = NULL;
+}
+
+static cc_result GZipParallel_StreamClose(struct Stream* stream) {
+	struct GZipParallelState* state = (struct GZipParallelState*)stream->Meta.Inflate;
+	cc_uint8 data[8];
+	cc_result res;
+
+	if (stream->Write == GZipParallel_StreamWriteFirst) {
+		cc_uint32 modified;
+		if ((res = GZipParallel_StreamWriteFirst(stream, NULL, 0, &modified))) goto finished;
+	}
+	state->LastBatch = true;
+	if ((res = GZipParallel_Flush(state))) goto finished;
+
+	if (state->ZLib) {
+		Stream_SetU32_BE(&data[0], state->Checksum);
+		res = Stream_Write(state->Dest, data, 4);
+	} else {
+		Stream_SetU32_LE(&data[0], state->Checksum);
+		Stream_SetU32_LE(&data[4], state->Size);
+		res = Stream_Write(state->Dest, data, 8);
+	}
+
+finished:
+	GZip_FreeParallelStream(state);
+	return res;
+}
+
+static void MakeParallelStream(struct Stream* stream, struct GZipParallelState* state, struct Stream* underlying, int level, cc_bool zlib) {
+	Stream_Init(stream);
+	stream->Meta.Inflate = state;
+	stream->Write = GZipParallel_StreamWriteFirst;
+	stream->Close = GZipParallel_StreamClose;
+
+	state->Dest      = underlying;
+	state->ZLib      = zlib;
+	state->Checksum  = zlib ? 1 : 0;
+	state->Size      = 0;
+	state->Level     = (level >= 0 && level <= DEFLATE_LEVEL_BEST) ? level : DEFLATE_LEVEL_DEFAULT;
+	state->InputLen  = 0;
+	state->HasWindow = false;
+	state->LastBatch = false;
+
+	state->Input  = NULL;
+	state->Output = NULL;
+	state->Chunks = NULL;
+}
+
+void GZip_MakeParallelStream(struct Stream* stream, struct GZipParallelState* state, struct Stream* underlying, int level) {
+	MakeParallelStream(stream, state, underlying, level, false);
+}
+
+void ZLib_MakeParallelStream(struct Stream* stream, struct GZipParallelState* state, struct Stream* underlying, int level) {
+	MakeParallelStream(stream, state, underlying, level, true);
+}
 
 /*########################################################################################################################*
 *-----------------------------------------------------ZLib (compress)-----------------------------------------------------*
@@ -1091,17 +1801,7 @@ static cc_result ZLib_StreamClose(struct Stream* stream) {
 
 static cc_result ZLib_StreamWrite(struct Stream* stream, const cc_uint8* data, cc_uint32 count, cc_uint32* modified) {
 	struct ZLibState* state = (struct ZLibState*)stream->Meta.Inflate;
-	cc_uint32 i, adler32 = state->Adler32;
-	cc_uint32 s1 = adler32 & 0xFFFF, s2 = (adler32 >> 16) & 0xFFFF;
-
-	/* TODO: Optimise this calculation */
-	for (i = 0; i < count; i++) {
-		#define ADLER32_BASE 65521
-		s1 = (s1 + data[i]) % ADLER32_BASE;
-		s2 = (s2 + s1)      % ADLER32_BASE;
-	}
-
-	state->Adler32 = (s2 << 16) | s1;
+	state->Adler32 = Utils_UpdateAdler32(state->Adler32, data, count);
 	return Deflate_StreamWrite(stream, data, count, modified);
 }
 
@@ -1110,18 +1810,24 @@ static cc_result ZLib_StreamWriteFirst(struct Stream* stream, const cc_uint8* da
 	struct ZLibState* state = (struct ZLibState*)stream->Meta.Inflate;
 	cc_result res;
 
-	if ((res = Stream_Write(state->Base.Dest, header, sizeof(header)))) return res;
+	if ((res = Stream_Write(state->Base.Dest, header, sizeof(header)))) {
+		Deflate_FreeTables(stream); return res;
+	}
 	stream->Write = ZLib_StreamWrite;
 	return ZLib_StreamWrite(stream, data, count, modified);
 }
 
-void ZLib_MakeStream(struct Stream* stream, struct ZLibState* state, struct Stream* underlying) {
-	Deflate_MakeStream(stream, &state->Base, underlying);
+void ZLib_MakeStream2(struct Stream* stream, struct ZLibState* state, struct Stream* underlying, int level) {
+	Deflate_MakeStream2(stream, &state->Base, underlying, level);
 	state->Adler32 = 1;
 	stream->Write = ZLib_StreamWriteFirst;
 	stream->Close = ZLib_StreamClose;
 }
 
+void ZLib_MakeStream(struct Stream* stream, struct ZLibState* state, struct Stream* underlying) {
+	ZLib_MakeStream2(stream, state, underlying, DEFLATE_LEVEL_DEFAULT);
+}
+
 
 /*########################################################################################################################*
 *--------------------------------------------------------ZipReader--------------------------------------------------------*
@@ -1220,6 +1926,7 @@ static cc_result Zip_ReadCentralDirectory(struct ZipState* state) {
 	entry->CompressedSize    = Stream_GetU32_LE(&header[16]);
 	entry->UncompressedSize  = Stream_GetU32_LE(&header[20]);
 	entry->LocalHeaderOffset = Stream_GetU32_LE(&header[38]);
+	entry->Decoded           = NULL;
 	return 0;
 }
 
@@ -1241,8 +1948,9 @@ enum ZipSig {
 	ZIP_SIG_LOCALFILEHEADER = 0x04034b50
 };
 
-cc_result Zip_Extract(struct Stream* source, Zip_SelectEntry selector, Zip_ProcessEntry processor) {
-	struct ZipState state;
+/* Reads the end of central directory and central directory entries */
+static cc_result Zip_ReadDirectory(struct ZipState* state) {
+	struct Stream* source = state->source;
 	cc_uint32 stream_len;
 	cc_uint32 sig = 0;
 	int i, count;
@@ -1260,24 +1968,20 @@ cc_result Zip_Extract(struct Stream* source, Zip_SelectEntry selector, Zip_Proce
 		if (sig == ZIP_SIG_ENDOFCENTRALDIR) break;
 	}
 
-	state.source       = source;
-	state.SelectEntry  = selector;
-	state.ProcessEntry = processor;
-
 	if (sig != ZIP_SIG_ENDOFCENTRALDIR) return ZIP_ERR_NO_END_OF_CENTRAL_DIR;
-	res = Zip_ReadEndOfCentralDirectory(&state);
+	res = Zip_ReadEndOfCentralDirectory(state);
 	if (res) return res;
 
-	res = source->Seek(source, state.centralDirBeg);
+	res = source->Seek(source, state->centralDirBeg);
 	if (res) return ZIP_ERR_SEEK_CENTRAL_DIR;
-	state.usedEntries = 0;
+	state->usedEntries = 0;
 
 	/* Read all the central directory entries */
-	for (i = 0; i < state.totalEntries; i++) {
+	for (i = 0; i < state->totalEntries; i++) {
 		if ((res = Stream_ReadU32_LE(source, &sig))) return res;
 
 		if (sig == ZIP_SIG_CENTRALDIR) {
-			res = Zip_ReadCentralDirectory(&state);
+			res = Zip_ReadCentralDirectory(state);
 			if (res) return res;
 		} else if (sig == ZIP_SIG_ENDOFCENTRALDIR) {
 			break;
@@ -1285,6 +1989,21 @@ cc_result Zip_Extract(struct Stream* source, Zip_SelectEntry selector, Zip_Proce
 			return ZIP_ERR_INVALID_CENTRAL_DIR;
 		}
 	}
+	return 0;
+}
+
+cc_result Zip_Extract(struct Stream* source, Zip_SelectEntry selector, Zip_ProcessEntry processor) {
+	struct ZipState state;
+	cc_uint32 sig = 0;
+	cc_result res;
+	int i;
+
+	state.source       = source;
+	state.SelectEntry  = selector;
+	state.ProcessEntry = processor;
+
+	res = Zip_ReadDirectory(&state);
+	if (res) return res;
 
 	/* Now read the local file header entries */
 	for (i = 0; i < state.usedEntries; i++) {
@@ -1300,3 +2019,239 @@ cc_result Zip_Extract(struct Stream* source, Zip_SelectEntry selector, Zip_Proce
 	}
 	return 0;
 }
+
+
+/*########################################################################################################################*
+*----------------------------------------------------Parallel ZipReader---------------------------------------------------*
+*#########################################################################################################################*/
+#ifdef CC_BUILD_LOWMEM
+cc_result Zip_ExtractParallel(struct Stream* source, Zip_SelectEntry selector, Zip_ProcessEntry processor,
+							Zip_DecodeEntry decoder, Zip_FreeDecoded freer) {
+	/* Not worth reading the whole archive into memory on systems with very limited memory */
+	return Zip_Extract(source, selector, processor);
+}
+#else
+/* Number of entries decompressed and decoded ahead of being processed */
+/* NOTE: Decoded entries (e.g. images) may use quite a lot of memory, so don't make this too large */
+#define ZIP_PARALLEL_BATCH 8
+/* Archives larger than this are extracted using Zip_Extract instead */
+#define ZIP_PARALLEL_MAX_SIZE (64 * 1024 * 1024)
+#define ZIP_LOCAL_HEADER_SIZE 30
+
+struct ZipParallelEntry {
+	struct ZipEntry* entry;
+	char pathBuffer[ZIP_MAXNAMELEN];
+	int pathLen, method;
+	cc_bool selected;
+	/* Entry data within the archive, as stored in the archive */
+	cc_uint8* data;
+	cc_uint32 dataLen, uncompressedLen;
+	/* Decompressed data, or NULL if entry is stored or could not be decompressed ahead of time */
+	cc_uint8* uncompressed;
+	void* decoded;
+};
+
+struct ZipParallelState {
+	struct ZipState* zip;
+	Zip_DecodeEntry DecodeEntry;
+	Zip_FreeDecoded FreeDecoded;
+	cc_uint8* archive;
+	cc_uint32 archiveLen;
+	struct ZipParallelEntry batch[ZIP_PARALLEL_BATCH];
+};
+
+/* Finds where the data of an entry starts, by reading its local file header directly from the archive */
+static cc_result ZipParallel_Locate(struct ZipParallelState* s, struct ZipParallelEntry* e) {
+	struct ZipEntry* entry = e->entry;
+	cc_uint32 offset = entry->LocalHeaderOffset;
+	cc_uint32 compressedSize, uncompressedSize;
+	cc_uint8* header;
+	cc_string path;
+	int extraLen;
+
+	if (offset > s->archiveLen || s->archiveLen - offset < ZIP_LOCAL_HEADER_SIZE) return ZIP_ERR_SEEK_LOCAL_DIR;
+	header = s->archive + offset;
+	if (Stream_GetU32_LE(header) != ZIP_SIG_LOCALFILEHEADER) return ZIP_ERR_INVALID_LOCAL_DIR;
+
+	e->pathLen = Stream_GetU16_LE(&header[26]);
+	extraLen   = Stream_GetU16_LE(&header[28]);
+	if (e->pathLen > ZIP_MAXNAMELEN) return ZIP_ERR_FILENAME_LEN;
+
+	offset += ZIP_LOCAL_HEADER_SIZE;
+	if (s->archiveLen - offset < (cc_uint32)e->pathLen) return ERR_END_OF_STREAM;
+	Mem_Copy(e->pathBuffer, s->archive + offset, e->pathLen);
+
+	path = String_Init(e->pathBuffer, e->pathLen, e->pathLen);
+	e->selected = s->zip->SelectEntry(&path);
+	if (!e->selected) return 0;
+
+	/* local file may have extra data before actual data (e.g. ZIP64) */
+	offset += e->pathLen;
+	if (s->archiveLen - offset < (cc_uint32)extraLen) return ERR_END_OF_STREAM;
+	offset += extraLen;
+
+	e->method        = Stream_GetU16_LE(&header[8]);
+	compressedSize   = Stream_GetU32_LE(&header[18]);
+	uncompressedSize = Stream_GetU32_LE(&header[22]);
+
+	/* Some .zip files don't set these in local file header */
+	if (!compressedSize)   compressedSize   = entry->CompressedSize;
+	if (!uncompressedSize) uncompressedSize = entry->UncompressedSize;
+
+	e->data            = s->archive + offset;
+	e->dataLen         = e->method == 0 ? uncompressedSize : compressedSize;
+	e->uncompressedLen = uncompressedSize;
+	/* Reading past end of archive fails later on, same as with Zip_Extract */
+	e->dataLen = min(e->dataLen, s->archiveLen - offset);
+	return 0;
+}
+
+/* Makes a stream that reads the uncompressed data of an entry */
+static cc_bool ZipParallel_MakeStream(struct ZipParallelEntry* e, struct Stream* stream, 
+									struct Stream* compStream, struct InflateState* inflate) {
+	if (e->method == 0) {
+		Stream_ReadonlyMemory(stream, e->data, e->dataLen);
+	} else if (e->uncompressed) {
+		Stream_ReadonlyMemory(stream, e->uncompressed, e->uncompressedLen);
+	} else if (e->method == 8) {
+		Stream_ReadonlyMemory(compStream, e->data, e->dataLen);
+		Inflate_MakeStream2(stream, inflate, compStream);
+	} else {
+		return false;
+	}
+	return true;
+}
+
+/* Decompresses and then decodes an entry. Called on multiple threads at once */
+static void ZipParallel_Decode(void* obj, int index) {
+	struct ZipParallelState* s  = (struct ZipParallelState*)obj;
+	struct ZipParallelEntry* e  = &s->batch[index];
+	struct InflateState* inflate;
+	struct Stream stream, compStream;
+	cc_string path;
+	cc_result res;
+	if (!e->selected) return;
+
+	/* If entry can't be fully decompressed ahead of time for whatever reason, */
+	/*  it is just decompressed while being processed instead (same as Zip_Extract) */
+	if (e->method == 8 && e->uncompressedLen) {
+		e->uncompressed = (cc_uint8*)Mem_TryAlloc(e->uncompressedLen, 1);
+		inflate = (struct InflateState*)Mem_TryAlloc(1, sizeof(struct InflateState));
+
+		if (e->uncompressed && inflate) {
+			Stream_ReadonlyMemory(&compStream, e->data, e->dataLen);
+			Inflate_MakeStream2(&stream, inflate, &compStream);
+			res = Stream_Read(&stream, e->uncompressed, e->uncompressedLen);
+		} else {
+			res = ERR_OUT_OF_MEMORY;
+		}
+
+		Mem_Free(inflate);
+		if (res) { Mem_Free(e->uncompressed); e->uncompressed = NULL; }
+	}
+
+	/* Entries that couldn't be decompressed ahead of time are left to be decoded while processing */
+	if (!s->DecodeEntry || (e->method == 8 && !e->uncompressed)) return;
+	if (!ZipParallel_MakeStream(e, &stream, NULL, NULL)) return;
+
+	path = String_Init(e->pathBuffer, e->pathLen, e->pathLen);
+	e->decoded = s->DecodeEntry(&path, &stream);
+}
+
+static cc_result ZipParallel_Process(struct ZipParallelState* s, struct ZipParallelEntry* e) {
+	struct InflateState inflate;
+	struct Stream stream, compStream;
+	cc_string path;
+	cc_result res;
+	if (!e->selected) return 0;
+
+	if (!ZipParallel_MakeStream(e, &stream, &compStream, &inflate)) {
+		Platform_Log1("Unsupported.zip entry compression method: %i", &e->method);
+		return 0;
+	}
+
+	path = String_Init(e->pathBuffer, e->pathLen, e->pathLen);
+	e->entry->Decoded = e->decoded;
+	res = s->zip->ProcessEntry(&path, &stream, e->entry);
+	e->entry->Decoded = NULL;
+	return res;
+}
+
+static void ZipParallel_FreeBatch(struct ZipParallelState* s, int count) {
+	struct ZipParallelEntry* e;
+	int i;
+
+	for (i = 0; i < count; i++) {
+		e = &s->batch[i];
+		Mem_Free(e->uncompressed);
+		if (e->decoded && s->FreeDecoded) s->FreeDecoded(e->decoded);
+	}
+}
+
+static cc_result ZipParallel_ExtractBatch(struct ZipParallelState* s, int beg, int count) {
+	struct ZipParallelEntry* e;
+	cc_result res = 0;
+	int i;
+
+	for (i = 0; i < count; i++) {
+		e = &s->batch[i];
+		e->entry        = &s->zip->entries[beg + i];
+		e->selected     = false;
+		e->uncompressed = NULL;
+		e->decoded      = NULL;
+	}
+
+	/* Local file headers are checked upfront, so errors are reported in the same order as Zip_Extract */
+	for (i = 0; i < count; i++) {
+		if ((res = ZipParallel_Locate(s, &s->batch[i]))) break;
+	}
+	Utils_ParallelFor(ZipParallel_Decode, s, i);
+
+	count = i;
+	for (i = 0; i < count && !res; i++) {
+		res = ZipParallel_Process(s, &s->batch[i]);
+	}
+
+	ZipParallel_FreeBatch(s, count);
+	return res;
+}
+
+cc_result Zip_ExtractParallel(struct Stream* source, Zip_SelectEntry selector, Zip_ProcessEntry processor,
+							Zip_DecodeEntry decoder, Zip_FreeDecoded freer) {
+	struct ZipParallelState s;
+	struct ZipState state;
+	struct Stream archive;
+	cc_uint32 length;
+	cc_result res;
+	int i, count;
+
+	if ((res = source->Length(source, &length))) return res;
+	s.archive = NULL;
+	/* NOTE: There is no platform API for memory mapping files, so read the whole archive instead */
+	if (length && length <= ZIP_PARALLEL_MAX_SIZE) s.archive = (cc_uint8*)Mem_TryAlloc(length, 1);
+	if (!s.archive) return Zip_Extract(source, selector, processor);
+
+	res = source->Seek(source, 0);
+	if (!res) res = Stream_Read(source, s.archive, length);
+	if (res) { Mem_Free(s.archive); return res; }
+
+	Stream_ReadonlyMemory(&archive, s.archive, length);
+	state.source       = &archive;
+	state.SelectEntry  = selector;
+	state.ProcessEntry = processor;
+
+	s.zip         = &state;
+	s.DecodeEntry = decoder;
+	s.FreeDecoded = freer;
+	s.archiveLen  = length;
+
+	res = Zip_ReadDirectory(&state);
+	for (i = 0; i < state.usedEntries && !res; i += ZIP_PARALLEL_BATCH) {
+		count = min(ZIP_PARALLEL_BATCH, state.usedEntries - i);
+		res   = ZipParallel_ExtractBatch(&s, i, count);
+	}
+
+	Mem_Free(s.archive);
+	return res;
+}
+#endif
@@ -78,11 +78,19 @@ void Inflate_Process(struct InflateState* s);
 CC_API void Inflate_MakeStream2(struct Stream* stream, struct InflateState* state, struct Stream* underlying);
 
 
+/* Compression levels, from fastest to smallest output */
+#define DEFLATE_LEVEL_STORE   0 /* Data is written as-is without any compression */
+#define DEFLATE_LEVEL_FASTEST 1 /* Only runs of the same byte are compressed */
+#define DEFLATE_LEVEL_DEFAULT 5
+#define DEFLATE_LEVEL_BEST    9
+
 #define DEFLATE_BLOCK_SIZE  16384
 #define DEFLATE_BUFFER_SIZE 32768
 #define DEFLATE_OUT_SIZE 8192
 #define DEFLATE_HASH_SIZE 0x1000UL
 #define DEFLATE_HASH_MASK 0x0FFFUL
+/* NOTE: Input, Head, Prev and WroteHeader are unused, and only kept so that the size of this struct */
+/*  doesn't change. The compressor instead uses larger tables allocated by Deflate_MakeStream. */
 struct DeflateState {
 	cc_uint32 Bits;         /* Holds bits across byte boundaries */
 	cc_uint32 NumBits;      /* Number of bits in Bits buffer */
@@ -105,22 +113,63 @@ struct DeflateState {
 };
 /* Compresses input data using DEFLATE, then writes compressed output to another stream. Write only stream. */
 /* DEFLATE compression is pure compressed data, there is no header or footer. */
+/* NOTE: Close must always be called (unless Write failed), to free the match finding tables. */
 CC_API void Deflate_MakeStream(struct Stream* stream, struct DeflateState* state, struct Stream* underlying);
+/* Same as Deflate_MakeStream, except that level is the compression level to use. (see DEFLATE_LEVEL_) */
+CC_API void Deflate_MakeStream2(struct Stream* stream, struct DeflateState* state, struct Stream* underlying, int level);
 
 struct GZipState { struct DeflateState Base; cc_uint32 Crc32, Size; };
 /* Compresses input data using GZIP, then writes compressed output to another stream. Write only stream. */
 /* GZIP compression is GZIP header, followed by DEFLATE compressed data, followed by GZIP footer. */
 CC_API  void GZip_MakeStream(      struct Stream* stream, struct GZipState* state, struct Stream* underlying);
 typedef void (*FP_GZip_MakeStream)(struct Stream* stream, struct GZipState* state, struct Stream* underlying);
+/* Same as GZip_MakeStream, except that level is the compression level to use. (see DEFLATE_LEVEL_) */
+CC_API void GZip_MakeStream2(struct Stream* stream, struct GZipState* state, struct Stream* underlying, int level);
+
+#ifdef CC_BUILD_LOWMEM
+#define GZIP_PARALLEL_CHUNKS 2
+#else
+#define GZIP_PARALLEL_CHUNKS 16
+#endif
+#define GZIP_PARALLEL_CHUNK_SIZE (128 * 1024)
+struct GZipParallelState {
+	struct Stream* Dest;
+	cc_bool ZLib;       /* Whether to write ZLIB instead of GZIP header and footer */
+	cc_uint32 Checksum; /* CRC32 (GZIP) or Adler32 (ZLIB) of all data so far */
+	cc_uint32 Size;
+	int Level;
+	cc_uint8* Input;    /* Previous window of data, followed by data of each chunk */
+	cc_uint32 InputLen; /* Number of bytes of chunk data in Input */
+	cc_bool HasWindow;  /* Whether start of Input holds data from previous batch of chunks */
+	cc_bool LastBatch;
+	cc_uint8* Output;   /* Compressed output of each chunk */
+	struct GZipParallelChunk* Chunks;
+};
+/* Compresses input data using GZIP, then writes compressed output to another stream. Write only stream. */
+/* Input data is split into chunks, which are each compressed as separate DEFLATE blocks on multiple threads. */
+/* The output is a standard GZIP stream, that is usually only very slightly larger than from GZip_MakeStream. */
+/* NOTE: Close or GZip_FreeParallelStream must always be called, to free the buffers allocated by the first Write. */
+CC_API void GZip_MakeParallelStream(struct Stream* stream, struct GZipParallelState* state, struct Stream* underlying, int level);
+/* Same as GZip_MakeParallelStream, except that the output is a standard ZLIB stream instead. */
+CC_API void ZLib_MakeParallelStream(struct Stream* stream, struct GZipParallelState* state, struct Stream* underlying, int level);
+/* Frees the buffers of a parallel GZIP/ZLIB stream, without writing out any remaining data or the footer. */
+/* NOTE: Use this instead of Close when an error occurred, as the output is going to be discarded anyways. */
+CC_API void GZip_FreeParallelStream(struct GZipParallelState* state);
 
 struct ZLibState { struct DeflateState Base; cc_uint32 Adler32; };
 /* Compresses input data using ZLIB, then writes compressed output to another stream. Write only stream. */
 /* ZLIB compression is ZLIB header, followed by DEFLATE compressed data, followed by ZLIB footer. */
 CC_API  void ZLib_MakeStream(      struct Stream* stream, struct ZLibState* state, struct Stream* underlying);
 typedef void (*FP_ZLib_MakeStream)(struct Stream* stream, struct ZLibState* state, struct Stream* underlying);
+/* Same as ZLib_MakeStream, except that level is the compression level to use. (see DEFLATE_LEVEL_) */
+CC_API void ZLib_MakeStream2(struct Stream* stream, struct ZLibState* state, struct Stream* underlying, int level);
 
 /* Minimal data needed to describe an entry in a .zip archive */
-struct ZipEntry { cc_uint32 CompressedSize, UncompressedSize, LocalHeaderOffset, CRC32; };
+struct ZipEntry { 
+	cc_uint32 CompressedSize, UncompressedSize, LocalHeaderOffset, CRC32;
+	/* Result from Zip_DecodeEntry for this entry, or NULL if not decoded ahead of time */
+	void* Decoded;
+};
 /* Callback function to process the data in a .zip archive entry */
 /* Return non-zero to indicate an error and stop further processing */
 /* NOTE: data stream MAY NOT be seekable (i.e. entry data might be compressed) */
@@ -130,4 +179,17 @@ typedef cc_result (*Zip_ProcessEntry)(const cc_string* path, struct Stream* data
 typedef cc_bool (*Zip_SelectEntry)(const cc_string* path);
 
 CC_API cc_result Zip_Extract(struct Stream* source, Zip_SelectEntry selector, Zip_ProcessEntry processor);
+
+/* Callback function to decode the data in a .zip archive entry ahead of time (e.g. decoding an image) */
+/* Returns the decoded result, or NULL if the entry was not decoded */
+/* NOTE: This may be called on any thread, and so must not access global state without a lock */
+typedef void* (*Zip_DecodeEntry)(const cc_string* path, struct Stream* data);
+/* Callback function to free the result of Zip_DecodeEntry, after the entry has been processed */
+typedef void  (*Zip_FreeDecoded)(void* decoded);
+/* Extracts entries in the same order as Zip_Extract, but with the whole archive read into memory first. */
+/* Entries are then decompressed and decoded using multiple threads, in batches ahead of being processed. */
+/* NOTE: processor is still only ever called on the calling thread. decoder and freer may be NULL. */
+/* NOTE: Falls back to Zip_Extract if there isn't enough memory to read the whole archive */
+CC_API cc_result Zip_ExtractParallel(struct Stream* source, Zip_SelectEntry selector, Zip_ProcessEntry processor,
+									Zip_DecodeEntry decoder, Zip_FreeDecoded freer);
 #endif
@@ -617,11 +617,11 @@ void Drawer2D_DrawClippedText(struct Context2D* ctx, struct DrawTextArgs* args,
 /*########################################################################################################################*
 *---------------------------------------------------Drawer2D component----------------------------------------------------*
 *#########################################################################################################################*/
-static void DefaultPngProcess(struct Stream* stream, const cc_string* name) {
+static void DefaultPngProcess(struct Stream* stream, const cc_string* name, struct Bitmap* decoded) {
 	struct Bitmap bmp;
 	cc_result res;
 
-	if ((res = Png_Decode(&bmp, stream))) {
+	if ((res = TextureEntry_DecodePng(&bmp, stream, decoded))) {
 		Logger_SysWarn2(res, "decoding", name);
 		Mem_Free(bmp.scan0);
 	} else if (Font_SetBitmapAtlas(&bmp)) {
@@ -428,12 +428,14 @@ void Entities_Tick(struct ScheduledTask* task) {
 void Entities_RenderModels(double delta, float t) {
 	int i;
 	Gfx_SetAlphaTest(true);
+	Model_BeginBatch();
 	
 	for (i = 0; i < ENTITIES_MAX_COUNT; i++) 
 	{
 		if (!Entities.List[i]) continue;
 		Entities.List[i]->VTABLE->RenderModel(Entities.List[i], delta, t);
 	}
+	Model_EndBatch();
 	Gfx_SetAlphaTest(false);
 }
 
@@ -288,10 +288,11 @@ float HacksComp_CalcSpeedFactor(struct HacksComp* hacks, cc_bool canSpeed) {
 *#########################################################################################################################*/
 static void InterpComp_RemoveOldestRotY(struct InterpComp* interp) {
 	int i;
-	for (i = 0; i < Array_Elems(interp->RotYStates); i++) {
+	interp->RotYCount--;
+
+	for (i = 0; i < interp->RotYCount; i++) {
 		interp->RotYStates[i] = interp->RotYStates[i + 1];
 	}
-	interp->RotYCount--;
 }
 
 static void InterpComp_AddRotY(struct InterpComp* interp, float state) {
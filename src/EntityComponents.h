@@ -88,6 +88,7 @@ void LocalInterpComp_AdvanceState(struct InterpComp* interp, struct Entity* e);
 struct NetInterpAngles { float Pitch, Yaw, RotX, RotZ; };
 
 /* Entity component that performs interpolation for network players */
+/* NOTE: Layout must stay the same, as plugins access NetPlayer fields directly */
 struct NetInterpComp {
 	InterpComp_Layout
 	/* Last known position and orientation sent by the server */
@@ -132,5 +132,10 @@ enum CC_ERRORS {
 	HTTP_ERR_RELATIVE    = 0xCCDED069UL, /* Unsupported relative URL format */
 	HTTP_ERR_INVALID_BODY= 0xCCDED06AUL, /* HTTP message doesn't have Content-Length or use Chunked transfer encoding */
 	HTTP_ERR_CHUNK_SIZE  = 0xCCDED06BUL, /* HTTP message chunk has negative size/length */
+
+	CWR_ERR_MAGIC    = 0xCCDED06CUL, /* CWR stream bytes #1-#4 aren't "CWRG" */
+	CWR_ERR_VERSION  = 0xCCDED06DUL, /* CWR header has unsupported version or region size */
+	CWR_ERR_REGION   = 0xCCDED06EUL, /* CWR region or metadata lies outside the file */
+	CWR_ERR_CHECKSUM = 0xCCDED06FUL, /* CWR region data doesn't match its CRC32 checksum */
 };
 #endif
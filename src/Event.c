@@ -81,6 +81,8 @@ void Event_UnregisterAll(void) {
 	WorldEvents.Loading.Count   = 0;
 	WorldEvents.MapLoaded.Count = 0;
 	WorldEvents.EnvVarChanged.Count = 0;
+	WorldEvents.Saving.Count    = 0;
+	WorldEvents.Saved.Count     = 0;
 
 	ChatEvents.FontChanged.Count    = 0;
 	ChatEvents.ChatReceived.Count   = 0;
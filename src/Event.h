@@ -158,6 +158,8 @@ CC_VAR extern struct _WorldEventsList {
 	struct Event_Float Loading;       /* Portion of world is decompressed/generated (Arg is progress from 0-1) */
 	struct Event_Void  MapLoaded;     /* New world has finished loading, player can now interact with it */
 	struct Event_Int   EnvVarChanged; /* World environment variable changed by player/CPE/WoM config */
+	struct Event_Float Saving;        /* Portion of world is written out by a background save (Arg is progress from 0-1) */
+	struct Event_Int   Saved;         /* Background save has finished (Arg is result, 0 if successful) */
 } WorldEvents;
 
 CC_VAR extern struct _ChatEventsList {
@@ -59,7 +59,10 @@ struct MapImporter* MapImporter_Find(const cc_string* path) {
 	return NULL;
 }
 
+static void Cwj_Open(const cc_string* mapPath);
+
 cc_result Map_LoadFrom(const cc_string* path) {
+	static const cc_string cw = String_FromConst(".cw");
 	cc_string relPath, fileName, fileExt;
 	struct MapImporter* imp;
 	struct Stream stream;
@@ -81,6 +84,7 @@ cc_result Map_LoadFrom(const cc_string* path) {
 	(void)stream.Close(&stream);
 	if (res) Logger_SysWarn2(res, "decoding", path);
 
+	if (!res && String_CaselessEnds(path, &cw)) Cwj_Open(path);
 	World_SetNewMap(World.Blocks, World.Width, World.Height, World.Length);
 	if (calcDefaultSpawn) LocalPlayer_CalcDefaultSpawn();
 	LocalPlayer_MoveToSpawn();
@@ -315,6 +319,7 @@ enum NbtTagType {
 
 #define NBT_SMALL_SIZE  STRING_SIZE
 #define NBT_STRING_SIZE STRING_SIZE
+#define NBT_BUFFER_SIZE 4096
 
 #define NbtTag_IsSmall(tag) ((tag)->dataSize <= NBT_SMALL_SIZE)
 #define IsTag(tag, tagName) (String_CaselessEqualsConst(&tag->name, tagName))
@@ -512,18 +517,28 @@ static BlockRaw* Nbt_TakeArray(struct NbtTag* tag, const char* type) {
 	return ptr;
 }
 
-static cc_result Nbt_Read(struct Stream* stream, Nbt_Callback callback) {
-	struct Stream compStream;
+/* Reads NBT tags from DEFLATE compressed data */
+static cc_result Nbt_ReadCompressed(struct Stream* stream, Nbt_Callback callback) {
+	struct Stream compStream, bufStream;
 	struct InflateState state;
+	cc_uint8 buffer[NBT_BUFFER_SIZE];
 	cc_result res;
 	cc_uint8 tag;
-
 	Inflate_MakeStream2(&compStream, &state, stream);
-	if ((res = Map_SkipGZipHeader(stream))) return res;
-	if ((res = compStream.ReadU8(&compStream, &tag))) return res;
+
+	/* Tags are mostly read a few bytes at a time, so decompress them in larger chunks. */
+	/* Large arrays (e.g. BlockArray) bypass the buffer and get decompressed directly into the final array */
+	Stream_ReadonlyBuffered(&bufStream, &compStream, buffer, sizeof(buffer));
+	if ((res = bufStream.ReadU8(&bufStream, &tag))) return res;
 
 	if (tag != NBT_DICT) return CW_ERR_ROOT_TAG;
-	return Nbt_ReadTag(NBT_DICT, true, &compStream, NULL, callback, 0);
+	return Nbt_ReadTag(NBT_DICT, true, &bufStream, NULL, callback, 0);
+}
+
+static cc_result Nbt_Read(struct Stream* stream, Nbt_Callback callback) {
+	cc_result res;
+	if ((res = Map_SkipGZipHeader(stream))) return res;
+	return Nbt_ReadCompressed(stream, callback);
 }
 
 
@@ -1565,12 +1580,34 @@ static cc_result Cw_WriteBockDef(struct Stream* stream, int b) {
 	return Stream_Write(stream, buffer, (int)(cur - buffer));
 }
 
-cc_result Cw_Save(struct Stream* stream) {
-	cc_uint8 buffer[2048];
+static cc_result Cw_WriteBlocks(struct Stream* stream) {
+	cc_uint8 buffer[64];
 	cc_uint8* cur;
-	struct LocalPlayer* p = &LocalPlayer_Instance;
 	cc_result res;
-	int b;
+
+	cur = buffer;
+	cur = Nbt_WriteArray(cur, "BlockArray", World.Volume);
+
+	if ((res = Stream_Write(stream, buffer, (int)(cur - buffer)))) return res;
+	if ((res = Stream_Write(stream, World.Blocks, World.Volume)))  return res;
+
+#ifdef EXTENDED_BLOCKS
+	if (World.Blocks != World.Blocks2) {
+		cur = buffer;
+		cur = Nbt_WriteArray(cur, "BlockArray2", World.Volume);
+
+		if ((res = Stream_Write(stream, buffer, (int)(cur - buffer)))) return res;
+		if ((res = Stream_Write(stream, World.Blocks2, World.Volume))) return res;
+	}
+#endif
+	return 0;
+}
+
+/* Writes the ClassicWorld NBT tags that come before the BlockArray tags */
+static cc_result Cw_WriteHeader(struct Stream* stream) {
+	cc_uint8 buffer[512];
+	cc_uint8* cur;
+	struct LocalPlayer* p = &LocalPlayer_Instance;
 
 	cur = buffer;
 	cur = Nbt_WriteDict(cur,   "ClassicWorld");
@@ -1595,20 +1632,16 @@ cc_result Cw_Save(struct Stream* stream) {
 		cur  = Nbt_WriteUInt8(cur,  "H", Math_Deg2Packed(p->SpawnYaw));
 		cur  = Nbt_WriteUInt8(cur,  "P", Math_Deg2Packed(p->SpawnPitch));
 	} *cur++ = NBT_END;
-	cur = Nbt_WriteArray(cur, "BlockArray", World.Volume);
 
-	if ((res = Stream_Write(stream, buffer, (int)(cur - buffer)))) return res;
-	if ((res = Stream_Write(stream, World.Blocks, World.Volume)))  return res;
-
-#ifdef EXTENDED_BLOCKS
-	if (World.Blocks != World.Blocks2) {
-		cur = buffer;
-		cur = Nbt_WriteArray(cur, "BlockArray2", World.Volume);
+	return Stream_Write(stream, buffer, (int)(cur - buffer));
+}
 
-		if ((res = Stream_Write(stream, buffer, (int)(cur - buffer)))) return res;
-		if ((res = Stream_Write(stream, World.Blocks2, World.Volume))) return res;
-	}
-#endif
+/* Writes the ClassicWorld NBT tags that come after the BlockArray tags */
+static cc_result Cw_WriteMetadata(struct Stream* stream) {
+	cc_uint8 buffer[2048];
+	cc_uint8* cur;
+	cc_result res;
+	int b;
 
 	cur = buffer;
 	cur = Nbt_WriteDict(cur, "Metadata");
@@ -1672,6 +1705,1069 @@ cc_result Cw_Save(struct Stream* stream) {
 	return Stream_Write(stream, cw_end, sizeof(cw_end));
 }
 
+/* Writes the ClassicWorld NBT tags, optionally without the BlockArray tags */
+static cc_result Cw_WriteWorld(struct Stream* stream, cc_bool blocks) {
+	cc_result res;
+	if ((res = Cw_WriteHeader(stream))) return res;
+
+	if (blocks && (res = Cw_WriteBlocks(stream))) return res;
+	return Cw_WriteMetadata(stream);
+}
+
+cc_result Cw_Save(struct Stream* stream) {
+	return Cw_WriteWorld(stream, true);
+}
+
+
+/*########################################################################################################################*
+*--------------------------------------------ClassicWorld change journal--------------------------------------------------*
+*#########################################################################################################################*/
+/* Block changes in singleplayer are periodically appended to a journal file alongside the map file, */
+/*  which is replayed onto the map when it is next loaded. This makes autosaving cost proportional to */
+/*  number of block changes instead of map volume. Once the journal grows too large, the map is saved */
+/*  in the background, and the journal restarts from that snapshot. */
+/* Format: Header, then batches of changes, with each batch being written at once.
+	U32 "Identifier" (must be CWJ_MAGIC)
+	U16 "Version" (must be CWJ_VERSION)
+	U16 "Width", "Height", "Length"
+	Batches[]: U32 "Count", U32 "CRC32 of entries", then Count x { U32 "Index", U16 "Old", U16 "New" }
+	NOTE: Replay stops at a partially written or inconsistent batch (e.g. game crashed while writing)
+*/
+#define CWJ_MAGIC   0x43574A4CUL /* "CWJL" */
+#define CWJ_VERSION 1
+#define CWJ_HEADER_SIZE 12
+#define CWJ_ENTRY_SIZE  8
+#define CWJ_AUTOSAVE_INTERVAL 30.0
+#define CWJ_DEF_ENTRIES 256
+/* Map is compacted once the journal is larger than a quarter of the map volume */
+#define CWJ_COMPACT_RATIO 4
+
+struct CwjEntry { cc_uint32 index; BlockID old, now; };
+static struct CwjEntry cwj_defEntries[CWJ_DEF_ENTRIES];
+static char cwj_pathBuffer[FILENAME_SIZE];
+
+static struct CwjState {
+	struct CwjEntry* entries;
+	int capacity, count;
+	cc_string path;     /* Map file the journal belongs to */
+	int flushed;        /* Entries already written to the journal file (only kept while compacting) */
+	cc_uint32 written;  /* Entries in the journal file */
+	cc_bool create;     /* Whether the journal file needs to be created again */
+	cc_bool compact;    /* Whether the map should be saved, and the journal restarted */
+	cc_bool compacting; /* Whether the map is being saved in the background */
+} cwj = { cwj_defEntries, CWJ_DEF_ENTRIES, 0, String_FromArray(cwj_pathBuffer) };
+
+static cc_result CwSave_Start(const cc_string* path, cc_bool quiet);
+
+static void Cwj_GetPath(cc_string* path) {
+	String_Format1(path, "%sj", &cwj.path);
+}
+
+void Cwj_OnBlockChanged(int x, int y, int z, BlockID old, BlockID now) {
+	struct CwjEntry* entry;
+	if (!cwj.path.length || old == now) return;
+
+	if (cwj.count == cwj.capacity) {
+		Utils_Resize((void**)&cwj.entries, &cwj.capacity,
+			sizeof(struct CwjEntry), CWJ_DEF_ENTRIES, CWJ_DEF_ENTRIES);
+	}
+	entry = &cwj.entries[cwj.count++];
+
+	entry->index = World_Pack(x, y, z);
+	entry->old   = old;
+	entry->now   = now;
+}
+
+
+/*########################################################################################################################*
+*------------------------------------------------ClassicWorld journal replay----------------------------------------------*
+*#########################################################################################################################*/
+static int Cwj_GetRaw(int i) {
+	int block = World.Blocks[i];
+#ifdef EXTENDED_BLOCKS
+	if (World.Blocks2 && World.Blocks2 != World.Blocks) block |= World.Blocks2[i] << 8;
+#endif
+	return block;
+}
+
+static cc_bool Cwj_SetRaw(int i, int block) {
+	World.Blocks[i] = (BlockRaw)block;
+#ifdef EXTENDED_BLOCKS
+	if (!World.Blocks2 || World.Blocks2 == World.Blocks) {
+		if (block < 256) return true;
+
+		World.Blocks2 = (BlockRaw*)Mem_TryAllocCleared(World.Volume, 1);
+		if (!World.Blocks2) return false;
+		World_SetMapUpper(World.Blocks2);
+	}
+	World.Blocks2[i] = (BlockRaw)(block >> 8);
+	return true;
+#else
+	return block < 256;
+#endif
+}
+
+/* Applies a batch of changes, undoing them all if the batch doesn't match the world */
+static cc_bool Cwj_ApplyBatch(cc_uint8* data, int count) {
+	cc_uint32 index;
+	int i, old, now;
+
+	for (i = 0; i < count; i++) {
+		index = Stream_GetU32_LE(data + i * CWJ_ENTRY_SIZE);
+		old   = Stream_GetU16_LE(data + i * CWJ_ENTRY_SIZE + 4);
+		now   = Stream_GetU16_LE(data + i * CWJ_ENTRY_SIZE + 6);
+
+		if (index >= (cc_uint32)World.Volume || Cwj_GetRaw(index) != old) break;
+		if (!Cwj_SetRaw(index, now)) break;
+	}
+	if (i == count) return true;
+
+	for (i--; i >= 0; i--) {
+		index = Stream_GetU32_LE(data + i * CWJ_ENTRY_SIZE);
+		old   = Stream_GetU16_LE(data + i * CWJ_ENTRY_SIZE + 4);
+		Cwj_SetRaw(index, old);
+	}
+	return false;
+}
+
+/* Replays the journal onto the just imported world, returning whether the entire journal was valid */
+static cc_bool Cwj_Replay(struct Stream* stream) {
+	cc_uint8 header[CWJ_HEADER_SIZE];
+	cc_uint32 length, pos, count, crc;
+	cc_uint8* data;
+	cc_bool valid;
+
+	if (stream->Length(stream, &length))             return false;
+	if (Stream_Read(stream, header, CWJ_HEADER_SIZE)) return false;
+
+	if (Stream_GetU32_BE(&header[0]) != CWJ_MAGIC)   return false;
+	if (Stream_GetU16_LE(&header[4]) != CWJ_VERSION) return false;
+	if (Stream_GetU16_LE(&header[6])  != World.Width)  return false;
+	if (Stream_GetU16_LE(&header[8])  != World.Height) return false;
+	if (Stream_GetU16_LE(&header[10]) != World.Length) return false;
+
+	for (pos = CWJ_HEADER_SIZE; pos < length; pos += 8 + count * CWJ_ENTRY_SIZE) {
+		if (length - pos < 8 || Stream_Read(stream, header, 8)) return false;
+		count = Stream_GetU32_LE(&header[0]);
+		crc   = Stream_GetU32_LE(&header[4]);
+		if (count > (length - pos - 8) / CWJ_ENTRY_SIZE) return false;
+
+		data = (cc_uint8*)Mem_TryAlloc(count, CWJ_ENTRY_SIZE);
+		if (!data) return false;
+
+		valid = !Stream_Read(stream, data, count * CWJ_ENTRY_SIZE)
+			&& Utils_CRC32(data, count * CWJ_ENTRY_SIZE) == crc
+			&& Cwj_ApplyBatch(data, count);
+
+		Mem_Free(data);
+		if (!valid) return false;
+		cwj.written += count;
+	}
+	return true;
+}
+
+/* Replays the journal of the given map (if any), then starts recording changes to it */
+static void Cwj_Open(const cc_string* mapPath) {
+	cc_string path; char pathBuffer[FILENAME_SIZE];
+	struct Stream stream;
+	cc_result res;
+
+	/* Journal could only be compacted by rewriting the map in place, so don't journal at all */
+	if (!Server.IsSinglePlayer || !World.Blocks || !File_RenameSupported) return;
+	if (World.Volume != World.Width * World.Height * World.Length) return;
+
+	String_Copy(&cwj.path, mapPath);
+	String_InitArray(path, pathBuffer);
+	Cwj_GetPath(&path);
+
+	cwj.written = 0;
+	cwj.create  = true;
+	cwj.compact = false;
+
+	res = Stream_OpenFile(&stream, &path);
+	if (res == ReturnCode_FileNotFound) return;
+	if (res) { Logger_SysWarn2(res, "opening", &path); return; }
+
+	/* A damaged journal can't safely be appended to, so save the map and start afresh instead */
+	if (Cwj_Replay(&stream)) {
+		cwj.create  = false;
+	} else {
+		cwj.compact = true;
+	}
+	/* No point logging error for closing readonly file */
+	(void)stream.Close(&stream);
+}
+
+
+/*########################################################################################################################*
+*------------------------------------------------ClassicWorld journal export----------------------------------------------*
+*#########################################################################################################################*/
+static cc_result Cwj_Append(const cc_string* path, struct CwjEntry* entries, int count) {
+	struct Stream stream;
+	cc_uint8 header[CWJ_HEADER_SIZE];
+	cc_uint8* data;
+	cc_uint8* cur;
+	cc_result res, closeRes;
+	int i;
+
+	data = (cc_uint8*)Mem_TryAlloc(8 + count * CWJ_ENTRY_SIZE, 1);
+	if (!data) return ERR_OUT_OF_MEMORY;
+
+	for (i = 0, cur = data + 8; i < count; i++, cur += CWJ_ENTRY_SIZE) {
+		Stream_SetU32_LE(cur + 0, entries[i].index);
+		Stream_SetU16_LE(cur + 4, entries[i].old);
+		Stream_SetU16_LE(cur + 6, entries[i].now);
+	}
+	Stream_SetU32_LE(data + 0, count);
+	Stream_SetU32_LE(data + 4, Utils_CRC32(data + 8, count * CWJ_ENTRY_SIZE));
+
+	res = cwj.create ? Stream_CreateFile(&stream, path) : Stream_AppendFile(&stream, path);
+	if (res) { Mem_Free(data); return res; }
+
+	if (cwj.create) {
+		Stream_SetU32_BE(&header[0],  CWJ_MAGIC);
+		Stream_SetU16_LE(&header[4],  CWJ_VERSION);
+		Stream_SetU16_LE(&header[6],  World.Width);
+		Stream_SetU16_LE(&header[8],  World.Height);
+		Stream_SetU16_LE(&header[10], World.Length);
+		res = Stream_Write(&stream, header, CWJ_HEADER_SIZE);
+	}
+
+	/* Batch is written all at once, so that it is less likely to be only partially written */
+	if (!res && count) res = Stream_Write(&stream, data, 8 + count * CWJ_ENTRY_SIZE);
+	Mem_Free(data);
+
+	closeRes = stream.Close(&stream);
+	return res ? res : closeRes;
+}
+
+/* Writes out all changes that have not been written to the journal yet */
+static void Cwj_Flush(void) {
+	cc_string path; char pathBuffer[FILENAME_SIZE];
+	int count = cwj.count - cwj.flushed;
+	cc_result res;
+
+	if (!cwj.path.length || (!count && !cwj.create)) return;
+	String_InitArray(path, pathBuffer);
+	Cwj_GetPath(&path);
+
+	res = Cwj_Append(&path, &cwj.entries[cwj.flushed], count);
+	if (res) {
+		/* Changes are still kept in memory, and will be written out with the saved map instead */
+		Logger_SysWarn2(res, "writing", &path);
+		cwj.compact = true; return;
+	}
+
+	cwj.create   = false;
+	cwj.written += count;
+	if (cwj.written * CWJ_ENTRY_SIZE > World.Volume / CWJ_COMPACT_RATIO) cwj.compact = true;
+
+	/* Changes since the map snapshot are needed for the new journal once the map is saved */
+	if (cwj.compacting) {
+		cwj.flushed = cwj.count;
+	} else {
+		cwj.count   = 0;
+		cwj.flushed = 0;
+	}
+}
+
+static void Cwj_Tick(struct ScheduledTask* task) {
+	if (!cwj.path.length) return;
+
+	if (!cwj.compact || Cw_IsSavingInBackground()) {
+		Cwj_Flush();
+	} else if (CwSave_Start(&cwj.path, true)) {
+		/* Can't save the map in the background right now (e.g. out of memory), */
+		/*  so keep appending to the journal and try again at the next autosave */
+		Cwj_Flush();
+	}
+}
+
+/* Called when the world has been snapshotted to be saved to the given map file */
+static void Cwj_BeginSnapshot(const cc_string* path) {
+	if (!Server.IsSinglePlayer || !World.Blocks || !File_RenameSupported) return;
+
+	/* Keep the current journal up to date, in case saving the map fails */
+	Cwj_Flush();
+	cwj.count   = 0;
+	cwj.flushed = 0;
+
+	if (!String_Equals(&cwj.path, path)) {
+		String_Copy(&cwj.path, path);
+		cwj.create = true;
+	}
+	cwj.compacting = true;
+}
+
+/* Called when the world snapshot has finished being saved */
+static void Cwj_EndSnapshot(cc_result res) {
+	if (!cwj.compacting) return;
+	cwj.compacting = false;
+
+	/* Journal now starts from the just saved map */
+	if (!res) {
+		cwj.flushed = 0;
+		cwj.written = 0;
+		cwj.create  = true;
+		cwj.compact = false;
+	}
+	Cwj_Flush();
+}
+
+static void Cwj_Close(void) {
+	Cwj_Flush();
+	cwj.path.length = 0;
+	cwj.count       = 0;
+	cwj.flushed     = 0;
+}
+
+static void Cwj_Free(void) {
+	Cwj_Close();
+	if (cwj.entries != cwj_defEntries) Mem_Free(cwj.entries);
+
+	cwj.entries  = cwj_defEntries;
+	cwj.capacity = CWJ_DEF_ENTRIES;
+}
+
+
+/*########################################################################################################################*
+*--------------------------------------------ClassicWorld background export-----------------------------------------------*
+*#########################################################################################################################*/
+/* The blocks are copied into a snapshot on the main thread, then compressed and written out on a worker thread. */
+/* The map is written to a temp file first, which then replaces the actual map file once completely written. */
+#define CWSAVE_CHUNK_SIZE (64 * 1024)
+
+static struct CwSaveState {
+	void* thread;
+	cc_bool active;          /* Whether a background save is in progress */
+	volatile cc_bool done;   /* Whether the worker thread has finished */
+	volatile float progress; /* Portion of blocks written so far (0 to 1) */
+	cc_result result;
+	cc_bool quiet;           /* Whether to not show a chat message once saved */
+
+	BlockRaw* blocks;  /* Snapshot of World.Blocks (kept around for later saves) */
+	BlockRaw* blocks2; /* Snapshot of World.Blocks2 (stored after blocks), or same as blocks */
+	int volume, capacity;
+
+	cc_uint8* meta;    /* NBT tags before and after BlockArray tags */
+	cc_uint32 metaLen, metaCapacity, headerLen;
+	cc_string path; char pathBuffer[FILENAME_SIZE];
+	/* NOTE: Too large for the stack of the worker thread on some platforms */
+	struct GZipState* gzState;
+} cwSave;
+
+static cc_result CwSave_MetaWrite(struct Stream* s, const cc_uint8* data, cc_uint32 count, cc_uint32* modified) {
+	cc_uint32 len = cwSave.metaLen + count;
+	cc_uint8* meta;
+
+	if (len > cwSave.metaCapacity) {
+		if (cwSave.meta) {
+			meta = (cc_uint8*)Mem_TryRealloc(cwSave.meta, len + 4096, 1);
+		} else {
+			meta = (cc_uint8*)Mem_TryAlloc(len + 4096, 1);
+		}
+		if (!meta) return ERR_OUT_OF_MEMORY;
+
+		cwSave.meta         = meta;
+		cwSave.metaCapacity = len + 4096;
+	}
+
+	Mem_Copy(cwSave.meta + cwSave.metaLen, data, count);
+	cwSave.metaLen = len;
+	*modified      = count;
+	return 0;
+}
+
+static void CwSave_FreeSnapshot(void) {
+	Mem_Free(cwSave.blocks);
+
+	cwSave.blocks   = NULL;
+	cwSave.blocks2  = NULL;
+	cwSave.capacity = 0;
+}
+
+static cc_result CwSave_TakeSnapshot(void) {
+	int count = World.Volume;
+#ifdef EXTENDED_BLOCKS
+	if (World.Blocks != World.Blocks2) count *= 2;
+#endif
+
+	/* Reuse the snapshot from the prior save when possible */
+	if (count > cwSave.capacity) {
+		CwSave_FreeSnapshot();
+		cwSave.blocks = (BlockRaw*)Mem_TryAlloc(count, 1);
+		if (!cwSave.blocks) return ERR_OUT_OF_MEMORY;
+		cwSave.capacity = count;
+	}
+
+	cwSave.volume  = World.Volume;
+	cwSave.blocks2 = cwSave.blocks;
+	Mem_Copy(cwSave.blocks, World.Blocks, World.Volume);
+
+#ifdef EXTENDED_BLOCKS
+	if (World.Blocks != World.Blocks2) {
+		cwSave.blocks2 = cwSave.blocks + World.Volume;
+		Mem_Copy(cwSave.blocks2, World.Blocks2, World.Volume);
+	}
+#endif
+	return 0;
+}
+
+static cc_result CwSave_WriteArray(struct Stream* stream, const char* name, BlockRaw* blocks, int offset, int total) {
+	cc_uint8 buffer[64];
+	cc_uint8* cur;
+	cc_result res;
+	int i, count;
+
+	cur = buffer;
+	cur = Nbt_WriteArray(cur, name, cwSave.volume);
+	if ((res = Stream_Write(stream, buffer, (int)(cur - buffer)))) return res;
+
+	for (i = 0; i < cwSave.volume; i += count) {
+		count = min(cwSave.volume - i, CWSAVE_CHUNK_SIZE);
+		if ((res = Stream_Write(stream, blocks + i, count))) return res;
+		cwSave.progress = (float)(offset + i + count) / total;
+	}
+	return 0;
+}
+
+static cc_result CwSave_WriteTo(const cc_string* path) {
+	struct Stream stream, compStream;
+	int total = cwSave.volume;
+	cc_result res;
+
+	if (cwSave.blocks2 != cwSave.blocks) total *= 2;
+	if ((res = Stream_CreateFile(&stream, path))) return res;
+
+	/* Deliberately not GZip_MakeParallelStream, as that would block the main thread from using Utils_ParallelFor */
+	GZip_MakeStream(&compStream, cwSave.gzState, &stream);
+	res = Stream_Write(&compStream, cwSave.meta, cwSave.headerLen);
+	if (!res) res = CwSave_WriteArray(&compStream, "BlockArray", cwSave.blocks, 0, total);
+
+	if (!res && cwSave.blocks2 != cwSave.blocks) {
+		res = CwSave_WriteArray(&compStream, "BlockArray2", cwSave.blocks2, cwSave.volume, total);
+	}
+	if (!res) res = Stream_Write(&compStream, cwSave.meta + cwSave.headerLen, cwSave.metaLen - cwSave.headerLen);
+
+	if (res) {
+		compStream.Close(&compStream); /* frees compression buffers */
+		stream.Close(&stream);
+		return res;
+	}
+
+	if ((res = compStream.Close(&compStream))) {
+		stream.Close(&stream); return res;
+	}
+	return stream.Close(&stream);
+}
+
+static void CwSave_Run(void) {
+	cc_string tmp; char tmpBuffer[FILENAME_SIZE];
+	cc_result res;
+
+	String_InitArray(tmp, tmpBuffer);
+	String_Format1(&tmp, "%s.tmp", &cwSave.path);
+
+	res = CwSave_WriteTo(&tmp);
+	if (!res) res = File_Rename(&tmp, &cwSave.path);
+
+	cwSave.result = res;
+	cwSave.done   = true;
+}
+
+static void CwSave_Finish(void) {
+	Thread_Join(cwSave.thread);
+	cwSave.thread = NULL;
+	cwSave.active = false;
+
+	Mem_Free(cwSave.gzState);
+	cwSave.gzState = NULL;
+	Cwj_EndSnapshot(cwSave.result);
+}
+
+static void CwSave_Report(void) {
+	if (cwSave.result) {
+		Logger_SysWarn2(cwSave.result, "saving", &cwSave.path);
+	} else if (!cwSave.quiet) {
+		Chat_Add1("&eSaved map to: %s", &cwSave.path);
+	}
+	Event_RaiseInt(&WorldEvents.Saved, cwSave.result);
+}
+
+static void CwSave_Tick(struct ScheduledTask* task) {
+	if (!cwSave.active) return;
+
+	if (!cwSave.done) {
+		Event_RaiseFloat(&WorldEvents.Saving, cwSave.progress);
+		return;
+	}
+	CwSave_Finish();
+	CwSave_Report();
+}
+
+static cc_result CwSave_Start(const cc_string* path, cc_bool quiet) {
+	struct Stream stream;
+	cc_result res;
+
+	/* Map file would have to be written to directly, which truncates it if saving fails */
+	/*  in the background - so leave it to the caller to save on the main thread instead */
+	if (!File_RenameSupported) return ERR_NOT_SUPPORTED;
+
+	/* Only one save can be written out at a time */
+	if (cwSave.active) { CwSave_Finish(); CwSave_Report(); }
+	if ((res = CwSave_TakeSnapshot())) return res;
+
+	Stream_Init(&stream);
+	stream.Write   = CwSave_MetaWrite;
+	cwSave.metaLen = 0;
+
+	if ((res = Cw_WriteHeader(&stream)))   return res;
+	cwSave.headerLen = cwSave.metaLen;
+	if ((res = Cw_WriteMetadata(&stream))) return res;
+
+	cwSave.gzState = (struct GZipState*)Mem_TryAlloc(1, sizeof(struct GZipState));
+	if (!cwSave.gzState) return ERR_OUT_OF_MEMORY;
+
+	String_InitArray(cwSave.path, cwSave.pathBuffer);
+	String_Copy(&cwSave.path, path);
+	Cwj_BeginSnapshot(path);
+
+	cwSave.active   = true;
+	cwSave.done     = false;
+	cwSave.quiet    = quiet;
+	cwSave.progress = 0.0f;
+
+	cwSave.thread = Thread_Create(CwSave_Run);
+	Thread_Start2(cwSave.thread, CwSave_Run);
+	return 0;
+}
+
+cc_result Cw_SaveInBackground(const cc_string* path) {
+	return CwSave_Start(path, false);
+}
+
+cc_bool Cw_IsSavingInBackground(void) { return cwSave.active; }
+
+void Cw_BeginSave(const cc_string* path) {
+	/* Otherwise the older background snapshot would later replace the map saved now */
+	if (cwSave.active) { CwSave_Finish(); CwSave_Report(); }
+	Cwj_BeginSnapshot(path);
+}
+
+void Cw_EndSave(cc_result res) { Cwj_EndSnapshot(res); }
+
+static void CwSave_OnNewMap(void* obj) {
+	/* Journal must be left consistent with the saved map */
+	if (cwSave.active) { CwSave_Finish(); CwSave_Report(); }
+	Cwj_Close();
+
+	/* Snapshot memory is better off used for the new map */
+	CwSave_FreeSnapshot();
+}
+
+static void CwSave_Free(void) {
+	/* Make sure the map is completely written out before exiting */
+	if (cwSave.active) CwSave_Finish();
+	Cwj_Free();
+
+	CwSave_FreeSnapshot();
+	Mem_Free(cwSave.meta);
+	cwSave.meta         = NULL;
+	cwSave.metaCapacity = 0;
+}
+
+
+/*########################################################################################################################*
+*----------------------------------------------ClassicWorld regions format------------------------------------------------*
+*#########################################################################################################################*/
+/* ClassicWorld regions is a native map format, where the world is split into 32x32x32 regions that are each
+   compressed separately. This means regions can be decompressed in parallel when loading, and only regions
+   that have changed since the map was last saved need to be compressed again when saving.
+   All values are little endian. Regions at the edges of the world are smaller, if world size isn't a multiple of 32.
+U8[4]  "Magic" ("CWRG")
+U8     "Version", "RegionShift" (log2 of region size), "Layers" (2 if world has BlockArray2), "Reserved"
+U16    "Width", "Height", "Length", "Reserved"
+U32    "MetadataOffset", "MetadataLength"
+REGION "Regions"[RegionsX * RegionsY * RegionsZ] (same order as blocks)
+  U32  "Offset", "Length", "CRC32", "Adler32" (checksums are of uncompressed data)
+U8*    "Metadata" (DEFLATE compressed ClassicWorld NBT tags, without "BlockArray" and "BlockArray2")
+U8*    "RegionData" (DEFLATE compressed blocks in YZX order, with all lower blocks before all upper blocks)
+*/
+#define CWR_VERSION 1
+#define CWR_REGION_SHIFT 5
+#define CWR_MAX_SHIFT 6
+#define CWR_HEADER_SIZE 24
+#define CWR_ENTRY_SIZE  16
+/* Regions are compressed or decompressed by this many jobs at once */
+#define CWR_JOBS 16
+/* Number of regions compressed before being written to disc */
+#define CWR_SAVE_BATCH (CWR_JOBS * 16)
+
+static const cc_uint8 cwr_magic[4] = { 'C','W','R','G' };
+struct CwrRegion { cc_uint32 Offset, Length, Crc32, Adler32; };
+
+struct CwrJob {
+	struct InflateState* inflate;
+	struct DeflateState* deflate;
+	cc_uint8* raw;  /* Uncompressed region data */
+	cc_uint8* comp; /* Compressed region data */
+	cc_result result;
+};
+
+struct CwrState {
+	int shift, layers, width, height, length;
+	int regionsX, regionsY, regionsZ, count;
+	cc_uint32 metaOffset, metaLength, maxRaw, maxComp;
+	/* Contents of the whole file when loading */
+	cc_uint8* data;
+	cc_uint32 dataLen;
+	struct CwrRegion* regions;
+	/* Compressed data for each region in the current batch when saving */
+	cc_uint8* output[CWR_SAVE_BATCH];
+	int batchBeg, batchEnd;
+	/* Existing file being overwritten when saving, to reuse unchanged regions from */
+	struct CwrState* old;
+	struct CwrJob jobs[CWR_JOBS];
+};
+
+static void Cwr_InitState(struct CwrState* s, int shift, int width, int height, int length) {
+	int size = 1 << shift;
+	Mem_Set(s, 0, sizeof(struct CwrState));
+	s->shift  = shift;
+	s->width  = width; s->height = height; s->length = length;
+
+	s->regionsX = (width  + size - 1) >> shift;
+	s->regionsY = (height + size - 1) >> shift;
+	s->regionsZ = (length + size - 1) >> shift;
+	s->count    = s->regionsX * s->regionsY * s->regionsZ;
+
+	s->maxRaw  = 2 * size * size * size;
+	/* Worst case is one stored block per 16 KB of input (see Deflate_FlushBlock) */
+	s->maxComp = s->maxRaw + 5 * (s->maxRaw / DEFLATE_BLOCK_SIZE + 2) + 8;
+}
+
+static void Cwr_FreeState(struct CwrState* s) {
+	int i;
+	for (i = 0; i < CWR_JOBS; i++) {
+		Mem_Free(s->jobs[i].inflate);
+		Mem_Free(s->jobs[i].deflate);
+		Mem_Free(s->jobs[i].raw);
+		Mem_Free(s->jobs[i].comp);
+	}
+	Mem_Free(s->regions);
+	Mem_Free(s->data);
+}
+
+static cc_result Cwr_ReadHeader(struct CwrState* s, cc_uint8* data, cc_uint32 dataLen) {
+	int width, height, length;
+	struct CwrRegion* r;
+	cc_uint8* entry;
+	int i;
+
+	if (dataLen < CWR_HEADER_SIZE) return ERR_END_OF_STREAM;
+	if (!Mem_Equal(data, cwr_magic, sizeof(cwr_magic))) return CWR_ERR_MAGIC;
+	if (data[4] != CWR_VERSION) return CWR_ERR_VERSION;
+	if (data[5] < 1 || data[5] > CWR_MAX_SHIFT) return CWR_ERR_VERSION;
+
+	if (data[6] < 1 || data[6] > 2) return CWR_ERR_VERSION;
+
+	width  = Stream_GetU16_LE(&data[8]);
+	height = Stream_GetU16_LE(&data[10]);
+	length = Stream_GetU16_LE(&data[12]);
+	/* Region count is always <= volume, so this also ensures it can't overflow */
+	if ((cc_uint64)width * height * length > 0x7FFFFFFFUL) return CWR_ERR_VERSION;
+
+	Cwr_InitState(s, data[5], width, height, length);
+	s->data    = data;
+	s->dataLen = dataLen;
+	s->layers  = data[6];
+
+	s->metaOffset = Stream_GetU32_LE(&data[16]);
+	s->metaLength = Stream_GetU32_LE(&data[20]);
+	if (s->metaOffset > dataLen || s->metaLength > dataLen - s->metaOffset) return CWR_ERR_REGION;
+	if ((dataLen - CWR_HEADER_SIZE) / CWR_ENTRY_SIZE < (cc_uint32)s->count) return ERR_END_OF_STREAM;
+
+	s->regions = (struct CwrRegion*)Mem_TryAlloc(s->count, sizeof(struct CwrRegion));
+	if (!s->regions && s->count) return ERR_OUT_OF_MEMORY;
+
+	for (i = 0; i < s->count; i++) {
+		entry = data + CWR_HEADER_SIZE + i * CWR_ENTRY_SIZE;
+		r     = &s->regions[i];
+
+		r->Offset  = Stream_GetU32_LE(&entry[0]);
+		r->Length  = Stream_GetU32_LE(&entry[4]);
+		r->Crc32   = Stream_GetU32_LE(&entry[8]);
+		r->Adler32 = Stream_GetU32_LE(&entry[12]);
+		if (r->Offset > dataLen || r->Length > dataLen - r->Offset) return CWR_ERR_REGION;
+	}
+	return 0;
+}
+
+/* Calculates the origin and size of a region, returning the size of its uncompressed data */
+static int Cwr_GetRegion(struct CwrState* s, int index, IVec3* origin, IVec3* size) {
+	int maxSize = 1 << s->shift;
+	origin->X = (index % s->regionsX) << s->shift;
+	origin->Z = ((index / s->regionsX) % s->regionsZ) << s->shift;
+	origin->Y = ((index / s->regionsX) / s->regionsZ) << s->shift;
+
+	size->X = min(maxSize, s->width  - origin->X);
+	size->Y = min(maxSize, s->height - origin->Y);
+	size->Z = min(maxSize, s->length - origin->Z);
+	return size->X * size->Y * size->Z * s->layers;
+}
+
+/* Copies the blocks of a region either from the world into data, or from data into the world */
+static int Cwr_CopyRegion(struct CwrState* s, int index, cc_uint8* data, cc_bool toWorld) {
+	cc_uint8* cur = data;
+	IVec3 origin, size;
+	int x, y1, z1, width;
+	BlockRaw* blocks;
+	int i, y, z;
+
+	Cwr_GetRegion(s, index, &origin, &size);
+	x = origin.X; y1 = origin.Y; z1 = origin.Z; width = size.X;
+
+	for (i = 0; i < s->layers; i++) {
+		blocks = World.Blocks;
+#ifdef EXTENDED_BLOCKS
+		if (i) blocks = World.Blocks2;
+#else
+		/* Upper layer is meaningless without extended blocks support */
+		if (i) blocks = NULL;
+#endif
+
+		for (y = y1; y < y1 + size.Y; y++) {
+			for (z = z1; z < z1 + size.Z; z++) {
+				if (!blocks) {
+				} else if (toWorld) {
+					Mem_Copy(blocks + World_Pack(x, y, z), cur, width);
+				} else {
+					Mem_Copy(cur, blocks + World_Pack(x, y, z), width);
+				}
+				cur += width;
+			}
+		}
+	}
+	return (int)(cur - data);
+}
+
+
+/*########################################################################################################################*
+*--------------------------------------------ClassicWorld regions format import-------------------------------------------*
+*#########################################################################################################################*/
+static cc_result Cwr_LoadRegion(struct CwrState* s, struct CwrJob* job, int index) {
+	struct CwrRegion* r = &s->regions[index];
+	struct Stream src, stream;
+	IVec3 origin, size;
+	cc_result res;
+	int len;
+
+	len = Cwr_GetRegion(s, index, &origin, &size);
+	Stream_ReadonlyMemory(&src, s->data + r->Offset, r->Length);
+	Inflate_MakeStream2(&stream, job->inflate, &src);
+
+	if ((res = Stream_Read(&stream, job->raw, len))) return res;
+	if (Utils_CRC32(job->raw, len) != r->Crc32) return CWR_ERR_CHECKSUM;
+
+	Cwr_CopyRegion(s, index, job->raw, true);
+	return 0;
+}
+
+static void Cwr_LoadRegions(void* obj, int index) {
+	struct CwrState* s  = (struct CwrState*)obj;
+	struct CwrJob* job  = &s->jobs[index];
+	int i, beg, end;
+
+	beg = (int)((cc_uint64)s->count *  index      / CWR_JOBS);
+	end = (int)((cc_uint64)s->count * (index + 1) / CWR_JOBS);
+	if (beg == end) return;
+
+	job->inflate = (struct InflateState*)Mem_TryAlloc(1, sizeof(struct InflateState));
+	job->raw     = (cc_uint8*)Mem_TryAlloc(s->maxRaw, 1);
+	if (!job->inflate || !job->raw) { job->result = ERR_OUT_OF_MEMORY; return; }
+
+	for (i = beg; i < end && !job->result; i++) {
+		job->result = Cwr_LoadRegion(s, job, i);
+	}
+}
+
+static cc_result Cwr_LoadWorld(struct CwrState* s) {
+	struct Stream stream;
+	cc_result res;
+	int i;
+
+	Stream_ReadonlyMemory(&stream, s->data + s->metaOffset, s->metaLength);
+	if ((res = Nbt_ReadCompressed(&stream, Cw_Callback))) return res;
+
+	/* Dimensions from the header are what region data is actually based on */
+	World.Width  = s->width;
+	World.Height = s->height;
+	World.Length = s->length;
+	World.Volume = s->width * s->height * s->length;
+
+	World.Blocks = (BlockRaw*)Mem_TryAlloc(World.Volume, 1);
+	if (!World.Blocks) return ERR_OUT_OF_MEMORY;
+#ifdef EXTENDED_BLOCKS
+	if (s->layers == 2) {
+		World_SetMapUpper((BlockRaw*)Mem_TryAlloc(World.Volume, 1));
+		if (!World.Blocks2) return ERR_OUT_OF_MEMORY;
+	}
+#endif
+
+	Utils_ParallelFor(Cwr_LoadRegions, s, CWR_JOBS);
+	for (i = 0; i < CWR_JOBS; i++) {
+		if (s->jobs[i].result) return s->jobs[i].result;
+	}
+	return 0;
+}
+
+/* Imports a world from a .cwr ClassicWorld regions map file */
+static cc_result Cwr_Load(struct Stream* stream) {
+	struct CwrState s;
+	cc_uint32 length;
+	cc_uint8* data;
+	cc_result res;
+
+	Mem_Set(&s, 0, sizeof(s));
+	if ((res = stream->Length(stream, &length))) return res;
+	/* NOTE: There is no platform API for memory mapping files, so read the whole file instead */
+	data = (cc_uint8*)Mem_TryAlloc(length, 1);
+	if (!data) return ERR_OUT_OF_MEMORY;
+
+	if ((res = Stream_Read(stream, data, length))) { Mem_Free(data); return res; }
+	res    = Cwr_ReadHeader(&s, data, length);
+	s.data = data; /* in case Cwr_ReadHeader failed before setting it */
+
+	if (!res) res = Cwr_LoadWorld(&s);
+	Cwr_FreeState(&s);
+	return res;
+}
+
+
+/*########################################################################################################################*
+*--------------------------------------------ClassicWorld regions format export-------------------------------------------*
+*#########################################################################################################################*/
+static cc_result Cwr_OutputWrite(struct Stream* s, const cc_uint8* data, cc_uint32 count, cc_uint32* modified) {
+	if (count > s->Meta.Mem.Left) return ERR_END_OF_STREAM;
+	Mem_Copy(s->Meta.Mem.Cur, data, count);
+
+	s->Meta.Mem.Cur  += count;
+	s->Meta.Mem.Left -= count;
+	*modified = count;
+	return 0;
+}
+
+static cc_result Cwr_SaveRegion(struct CwrState* s, struct CwrJob* job, int index) {
+	struct CwrRegion* r = &s->regions[index];
+	struct CwrRegion* prior;
+	struct Stream stream, output;
+	cc_result res;
+	int len;
+
+	len = Cwr_CopyRegion(s, index, job->raw, false);
+	r->Crc32   = Utils_CRC32(job->raw, len);
+	r->Adler32 = Utils_UpdateAdler32(1, job->raw, len);
+
+	/* Region is unchanged since the file was last saved, so reuse the compressed data */
+	if (s->old) {
+		prior = &s->old->regions[index];
+		if (prior->Crc32 == r->Crc32 && prior->Adler32 == r->Adler32) {
+			r->Length = prior->Length;
+			s->output[index - s->batchBeg] = s->old->data + prior->Offset;
+			return 0;
+		}
+	}
+
+	Stream_Init(&output);
+	output.Write         = Cwr_OutputWrite;
+	output.Meta.Mem.Cur  = job->comp;
+	output.Meta.Mem.Left = s->maxComp;
+
+	Deflate_MakeStream(&stream, job->deflate, &output);
+	if ((res = Stream_Write(&stream, job->raw, len))) return res;
+	if ((res = stream.Close(&stream)))                return res;
+	r->Length = s->maxComp - output.Meta.Mem.Left;
+
+	s->output[index - s->batchBeg] = (cc_uint8*)Mem_TryAlloc(r->Length, 1);
+	if (!s->output[index - s->batchBeg]) return ERR_OUT_OF_MEMORY;
+	Mem_Copy(s->output[index - s->batchBeg], job->comp, r->Length);
+	return 0;
+}
+
+static void Cwr_SaveRegions(void* obj, int index) {
+	struct CwrState* s  = (struct CwrState*)obj;
+	struct CwrJob* job  = &s->jobs[index];
+	int i, count, beg, end;
+
+	count = s->batchEnd - s->batchBeg;
+	beg   = s->batchBeg + count *  index      / CWR_JOBS;
+	end   = s->batchBeg + count * (index + 1) / CWR_JOBS;
+	if (beg == end || job->result) return;
+
+	/* Buffers are kept around for the later batches */
+	if (!job->deflate) job->deflate = (struct DeflateState*)Mem_TryAlloc(1, sizeof(struct DeflateState));
+	if (!job->raw)     job->raw     = (cc_uint8*)Mem_TryAlloc(s->maxRaw,  1);
+	if (!job->comp)    job->comp    = (cc_uint8*)Mem_TryAlloc(s->maxComp, 1);
+	if (!job->deflate || !job->raw || !job->comp) { job->result = ERR_OUT_OF_MEMORY; return; }
+
+	for (i = beg; i < end && !job->result; i++) {
+		job->result = Cwr_SaveRegion(s, job, i);
+	}
+}
+
+/* Compresses the regions in the current batch, then writes them to the file in order */
+static cc_result Cwr_SaveBatch(struct CwrState* s, struct Stream* stream, cc_uint32* offset) {
+	struct CwrRegion* r;
+	cc_result res = 0;
+	int i;
+
+	Mem_Set(s->output, 0, sizeof(s->output));
+	Utils_ParallelFor(Cwr_SaveRegions, s, CWR_JOBS);
+	for (i = 0; i < CWR_JOBS && !res; i++) { res = s->jobs[i].result; }
+
+	for (i = s->batchBeg; i < s->batchEnd && !res; i++) {
+		r = &s->regions[i];
+		r->Offset = *offset;
+		*offset  += r->Length;
+		res = Stream_Write(stream, s->output[i - s->batchBeg], r->Length);
+	}
+
+	for (i = s->batchBeg; i < s->batchEnd; i++) {
+		/* Don't free data from the old file */
+		if (s->old && s->output[i - s->batchBeg] == s->old->data + s->old->regions[i].Offset) continue;
+		Mem_Free(s->output[i - s->batchBeg]);
+	}
+	return res;
+}
+
+static void Cwr_WriteHeader(struct CwrState* s, cc_uint8* data) {
+	struct CwrRegion* r;
+	cc_uint8* entry;
+	int i;
+
+	Mem_Set(data, 0, CWR_HEADER_SIZE);
+	Mem_Copy(data, cwr_magic, sizeof(cwr_magic));
+	data[4] = CWR_VERSION;
+	data[5] = s->shift;
+	data[6] = s->layers;
+
+	Stream_SetU16_LE(&data[8],  s->width);
+	Stream_SetU16_LE(&data[10], s->height);
+	Stream_SetU16_LE(&data[12], s->length);
+	Stream_SetU32_LE(&data[16], s->metaOffset);
+	Stream_SetU32_LE(&data[20], s->metaLength);
+
+	for (i = 0; i < s->count; i++) {
+		entry = data + CWR_HEADER_SIZE + i * CWR_ENTRY_SIZE;
+		r     = &s->regions[i];
+
+		Stream_SetU32_LE(&entry[0],  r->Offset);
+		Stream_SetU32_LE(&entry[4],  r->Length);
+		Stream_SetU32_LE(&entry[8],  r->Crc32);
+		Stream_SetU32_LE(&entry[12], r->Adler32);
+	}
+}
+
+static cc_result Cwr_WriteMetadata(struct Stream* stream) {
+	struct Stream compStream;
+	struct DeflateState* state;
+	cc_result res;
+
+	state = (struct DeflateState*)Mem_TryAlloc(1, sizeof(struct DeflateState));
+	if (!state) return ERR_OUT_OF_MEMORY;
+	Deflate_MakeStream(&compStream, state, stream);
+
+	res = Cw_WriteWorld(&compStream, false);
+	if (!res) res = compStream.Close(&compStream);
+	Mem_Free(state);
+	return res;
+}
+
+/* Reads the existing map file that is about to be overwritten, so its unchanged regions can be reused */
+static void Cwr_ReadOld(struct CwrState* old, const cc_string* path, struct CwrState* s) {
+	struct Stream stream;
+	cc_uint32 length;
+	cc_uint8* data = NULL;
+	cc_result res;
+	Mem_Set(old, 0, sizeof(struct CwrState));
+
+	if (Stream_OpenFile(&stream, path)) return;
+	res = stream.Length(&stream, &length);
+	if (!res) data = (cc_uint8*)Mem_TryAlloc(length, 1);
+	if (data) res  = Stream_Read(&stream, data, length);
+	(void)stream.Close(&stream);
+
+	if (!data) return;
+	if (!res) res = Cwr_ReadHeader(old, data, length);
+	old->data = data; /* in case Cwr_ReadHeader failed before setting it */
+
+	if (!res && old->shift == s->shift && old->layers == s->layers && old->width == s->width
+		&& old->height == s->height && old->length == s->length) {
+		s->old = old;
+	}
+}
+
+cc_result Cwr_Save(const cc_string* path) {
+	cc_string tmp; char tmpBuffer[FILENAME_SIZE];
+	const cc_string* dst = path;
+	struct CwrState s, old;
+	struct Stream stream;
+	cc_uint32 offset, headerLen;
+	cc_uint8* header;
+	cc_result res;
+
+	Cwr_InitState(&s, CWR_REGION_SHIFT, World.Width, World.Height, World.Length);
+	s.layers = 1;
+#ifdef EXTENDED_BLOCKS
+	if (World.Blocks != World.Blocks2) s.layers = 2;
+#endif
+
+	headerLen = CWR_HEADER_SIZE + s.count * CWR_ENTRY_SIZE;
+	header    = (cc_uint8*)Mem_TryAllocCleared(headerLen, 1);
+	s.regions = (struct CwrRegion*)Mem_TryAllocCleared(s.count + 1, sizeof(struct CwrRegion));
+	if (!header || !s.regions) { Mem_Free(header); Cwr_FreeState(&s); return ERR_OUT_OF_MEMORY; }
+	Cwr_ReadOld(&old, path, &s);
+
+	/* Write to a temp file and then replace the map, so a failed save doesn't corrupt it */
+	String_InitArray(tmp, tmpBuffer);
+	if (File_RenameSupported) {
+		String_Format1(&tmp, "%s.tmp", path);
+		dst = &tmp;
+	}
+
+	res = Stream_CreateFile(&stream, dst);
+	if (res) { Mem_Free(header); Cwr_FreeState(&old); Cwr_FreeState(&s); return res; }
+
+	/* Index is only known once all the regions have been written */
+	if ((res = Stream_Write(&stream, header, headerLen)))   goto finished;
+	if ((res = Cwr_WriteMetadata(&stream)))             goto finished;
+	if ((res = stream.Position(&stream, &offset)))          goto finished;
+	s.metaOffset = headerLen;
+	s.metaLength = offset - headerLen;
+
+	for (s.batchBeg = 0; s.batchBeg < s.count; s.batchBeg += CWR_SAVE_BATCH) {
+		s.batchEnd = min(s.count, s.batchBeg + CWR_SAVE_BATCH);
+		if ((res = Cwr_SaveBatch(&s, &stream, &offset))) goto finished;
+	}
+
+	Cwr_WriteHeader(&s, header);
+	if ((res = stream.Seek(&stream, 0))) goto finished;
+	res = Stream_Write(&stream, header, headerLen);
+
+finished:
+	if (res) {
+		(void)stream.Close(&stream);
+	} else {
+		res = stream.Close(&stream);
+	}
+	if (!res && dst != path) res = File_Rename(&tmp, path);
+
+	Mem_Free(header);
+	Cwr_FreeState(&old);
+	Cwr_FreeState(&s);
+	return res;
+}
+
 
 /*########################################################################################################################*
 *---------------------------------------------------Schematic export------------------------------------------------------*
@@ -1855,6 +2951,7 @@ cc_result Dat_Save(struct Stream* stream) {
 *-------------------------------------------------------Formats component-------------------------------------------------*
 *#########################################################################################################################*/
 static struct MapImporter cw_imp    = { ".cw",      Cw_Load };
+static struct MapImporter cwr_imp   = { ".cwr",     Cwr_Load };
 static struct MapImporter dat_imp   = { ".dat",     Dat_Load };
 static struct MapImporter lvl_imp   = { ".lvl",     Lvl_Load };
 static struct MapImporter mine_imp  = { ".mine",    Dat_Load };
@@ -1863,15 +2960,21 @@ static struct MapImporter mclvl_imp = { ".mclevel", MCLevel_Load };
 
 static void OnInit(void) {
 	MapImporter_Register(&cw_imp);
+	MapImporter_Register(&cwr_imp);
 	MapImporter_Register(&dat_imp);
 	MapImporter_Register(&lvl_imp);
 	MapImporter_Register(&mine_imp);
 	MapImporter_Register(&fcm_imp);
 	MapImporter_Register(&mclvl_imp);
+
+	ScheduledTask_Add(GAME_DEF_TICKS, CwSave_Tick);
+	ScheduledTask_Add(CWJ_AUTOSAVE_INTERVAL, Cwj_Tick);
+	Event_Register_(&WorldEvents.NewMap, NULL, CwSave_OnNewMap);
 }
 
 static void OnFree(void) {
 	imp_head = NULL;
+	CwSave_Free();
 }
 
 struct IGameComponent Formats_Component = {
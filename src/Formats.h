@@ -30,10 +30,27 @@ CC_API cc_result Map_LoadFrom(const cc_string* path);
 /* Exports a world to a .cw ClassicWorld map file. */
 /* Compatible with ClassiCube/ClassicalSharp */
 cc_result Cw_Save(struct Stream* stream);
+/* Exports a world to a .cw ClassicWorld map file on a background thread */
+/* Progress and completion are reported through WorldEvents.Saving and WorldEvents.Saved */
+/* NOTE: If a save is already in progress, waits for it to finish first */
+/* NOTE: Fails when not enough memory for a snapshot, or File_Rename isn't supported */
+cc_result Cw_SaveInBackground(const cc_string* path);
+/* Whether a map is currently being exported by Cw_SaveInBackground */
+cc_bool Cw_IsSavingInBackground(void);
+/* Must be called before and after exporting a .cw map file with Cw_Save */
+/* NOTE: This restarts the change journal of the map from the newly saved map */
+void Cw_BeginSave(const cc_string* path);
+void Cw_EndSave(cc_result res);
+/* Records a block change to the change journal of the current .cw map (if any) */
+/* NOTE: The journal is periodically appended to the file, and replayed when the map is next loaded */
+void Cwj_OnBlockChanged(int x, int y, int z, BlockID old, BlockID now);
 /* Exports a world to a .schematic Schematic map file */
 /* Used by MCEdit and other tools */
 cc_result Schematic_Save(struct Stream* stream);
 /* Exports a world to a .dat Classic map file */
 /* Used by MineCraft Classic */
 cc_result Dat_Save(struct Stream* stream);
+/* Exports a world to a .cwr ClassicWorld regions map file */
+/* Regions unchanged from the existing file at path (if any) are reused instead of compressed again */
+cc_result Cwr_Save(const cc_string* path);
 #endif
@@ -32,6 +32,7 @@
 #include "Menus.h"
 #include "Audio.h"
 #include "Stream.h"
+#include "Bitmap.h"
 #include "Builder.h"
 #include "Protocol.h"
 #include "Picking.h"
@@ -197,6 +198,8 @@ void Game_UpdateBlock(int x, int y, int z, BlockID block) {
 	}
 	Lighting.OnBlockChanged(x, y, z, old, block);
 	MapRenderer_OnBlockChanged(x, y, z, block);
+	Picking_OnBlockChanged(x, y, z, block);
+	Cwj_OnBlockChanged(x, y, z, old, block);
 }
 
 void Game_ChangeBlock(int x, int y, int z, BlockID block) {
@@ -211,12 +214,13 @@ cc_bool Game_CanPick(BlockID block) {
 	return Blocks.Collide[block] != COLLIDE_LIQUID || Game_BreakableLiquids;
 }
 
-cc_bool Game_UpdateTexture(GfxResourceID* texId, struct Stream* src, const cc_string* file, cc_uint8* skinType) {
+cc_bool Game_UpdateTexture(GfxResourceID* texId, struct Stream* src, struct Bitmap* decoded, 
+							const cc_string* file, cc_uint8* skinType) {
 	struct Bitmap bmp;
 	cc_bool success;
 	cc_result res;
 	
-	res = Png_Decode(&bmp, src);
+	res = TextureEntry_DecodePng(&bmp, src, decoded);
 	if (res) { Logger_SysWarn2(res, "decoding", file); }
 
 	success = !res && Game_ValidateBitmap(file, &bmp);
@@ -372,6 +376,9 @@ static void LoadPlugins(void) {
 #endif
 
 static void Game_Free(void* obj);
+#ifndef CC_BUILD_WEB
+static void Screenshot_Tick(struct ScheduledTask* task);
+#endif
 static void Game_Load(void) {
 	struct IGameComponent* comp;
 	Game_UpdateDimensions();
@@ -388,6 +395,8 @@ static void Game_Load(void) {
 	Event_Register_(&WindowEvents.Closing,         NULL, Game_Free);
 	Event_Register_(&WindowEvents.InactiveChanged, NULL, HandleInactiveChanged);
 
+	/* Must be initialised before any other threads might use Utils_ParallelFor */
+	Game_AddComponent(&Parallel_Component);
 	Game_AddComponent(&World_Component);
 	Game_AddComponent(&Textures_Component);
 	Game_AddComponent(&Input_Component);
@@ -422,6 +431,7 @@ static void Game_Load(void) {
 	Game_AddComponent(&AxisLinesRenderer_Component);
 	Game_AddComponent(&Formats_Component);
 	Game_AddComponent(&EntityRenderers_Component);
+	Game_AddComponent(&Picking_Component);
 
 	LoadPlugins();
 	for (comp = comps_head; comp; comp = comp->next) {
@@ -435,6 +445,9 @@ static void Game_Load(void) {
 	}
 
 	entTaskI = ScheduledTask_Add(GAME_DEF_TICKS, Entities_Tick);
+#ifndef CC_BUILD_WEB
+	ScheduledTask_Add(GAME_DEF_TICKS, Screenshot_Tick);
+#endif
 	if (Gfx_WarnIfNecessary()) EnvRenderer_SetMode(EnvRenderer_Minimal | ENV_LEGACY);
 	Server.BeginConnect();
 }
@@ -517,15 +530,64 @@ static void PerformScheduledTasks(double time) {
 	}
 }
 
-void Game_TakeScreenshot(void) {
+#ifndef CC_BUILD_WEB
+/* The back buffer is copied on the main thread, then encoded and written out on a worker thread */
+static struct ScreenshotState {
+	void* thread;
+	cc_bool active;        /* Whether a screenshot is being written out */
+	volatile cc_bool done; /* Whether the worker thread has finished */
+	cc_result result;
+	struct Bitmap bmp;
+	cc_bool bottomUp;      /* Whether rows of the bitmap are ordered bottom to top */
+	struct Stream stream;
 	cc_string filename; char fileBuffer[STRING_SIZE];
 	cc_string path;     char pathBuffer[FILENAME_SIZE];
+} shot;
+
+static BitmapCol* Screenshot_GetFlippedRow(struct Bitmap* bmp, int y) {
+	return Bitmap_GetRow(bmp, (bmp->height - 1) - y);
+}
+
+static void Screenshot_Run(void) {
+	Png_RowGetter getRow = shot.bottomUp ? Screenshot_GetFlippedRow : NULL;
+	cc_result res = Png_EncodeFast(&shot.bmp, &shot.stream, getRow, false);
+
+	if (res) {
+		shot.stream.Close(&shot.stream);
+	} else {
+		res = shot.stream.Close(&shot.stream);
+	}
+	shot.result = res;
+	shot.done   = true;
+}
+
+static void Screenshot_Finish(void) {
+	Thread_Join(shot.thread);
+	shot.thread = NULL;
+	shot.active = false;
+
+	Mem_Free(shot.bmp.scan0);
+	shot.bmp.scan0 = NULL;
+	if (shot.result) { Logger_SysWarn2(shot.result, "saving to", &shot.path); return; }
+
+	Chat_Add1("&eTaken screenshot as: %s", &shot.filename);
+#ifdef CC_BUILD_MOBILE
+	Platform_ShareScreenshot(&shot.filename);
+#endif
+}
+
+static void Screenshot_Tick(struct ScheduledTask* task) {
+	if (shot.active && shot.done) Screenshot_Finish();
+}
+#endif
+
+void Game_TakeScreenshot(void) {
+	cc_string filename; char fileBuffer[STRING_SIZE];
 	struct DateTime now;
-	cc_result res;
 #ifdef CC_BUILD_WEB
 	char str[NATIVE_STR_LEN];
 #else
-	struct Stream stream;
+	cc_result res;
 #endif
 	Game_ScreenshotRequested = false;
 	DateTime_CurrentLocal(&now);
@@ -540,24 +602,32 @@ void Game_TakeScreenshot(void) {
 	interop_TakeScreenshot(str);
 #else
 	if (!Utils_EnsureDirectory("screenshots")) return;
-	String_InitArray(path, pathBuffer);
-	String_Format1(&path, "screenshots/%s", &filename);
+	/* Only one screenshot can be written out at a time */
+	if (shot.active) Screenshot_Finish();
 
-	res = Stream_CreateFile(&stream, &path);
-	if (res) { Logger_SysWarn2(res, "creating", &path); return; }
+	String_InitArray(shot.filename, shot.fileBuffer);
+	String_Copy(&shot.filename, &filename);
+	String_InitArray(shot.path, shot.pathBuffer);
+	String_Format1(&shot.path, "screenshots/%s", &filename);
 
-	res = Gfx_TakeScreenshot(&stream);
-	if (res) { 
-		Logger_SysWarn2(res, "saving to", &path); stream.Close(&stream); return;
-	}
+	shot.bmp.scan0 = NULL;
+	shot.bottomUp  = false;
+	res = Gfx_TakeScreenshot(&shot.bmp, &shot.bottomUp);
+	if (res) { Logger_SysWarn2(res, "saving to", &shot.path); goto failed; }
 
-	res = stream.Close(&stream);
-	if (res) { Logger_SysWarn2(res, "closing", &path); return; }
-	Chat_Add1("&eTaken screenshot as: %s", &filename);
+	res = Stream_CreateFile(&shot.stream, &shot.path);
+	if (res) { Logger_SysWarn2(res, "creating", &shot.path); goto failed; }
 
-#ifdef CC_BUILD_MOBILE
-	Platform_ShareScreenshot(&filename);
-#endif
+	shot.active = true;
+	shot.done   = false;
+
+	shot.thread = Thread_Create(Screenshot_Run);
+	Thread_Start2(shot.thread, Screenshot_Run);
+	return;
+
+failed:
+	Mem_Free(shot.bmp.scan0);
+	shot.bmp.scan0 = NULL;
 #endif
 }
 
@@ -630,6 +700,10 @@ static void Game_Free(void* obj) {
 	Gfx.ManagedTextures = false;
 	Event_UnregisterAll();
 	tasksCount = 0;
+#ifndef CC_BUILD_WEB
+	/* Make sure the screenshot is completely written out before exiting */
+	if (shot.active) Screenshot_Finish();
+#endif
 
 	for (comp = comps_head; comp; comp = comp->next) {
 		if (comp->Free) comp->Free();
@@ -86,7 +86,9 @@ CC_API void Game_UpdateBlock(int x, int y, int z, BlockID block);
 CC_API void Game_ChangeBlock(int x, int y, int z, BlockID block);
 
 cc_bool Game_CanPick(BlockID block);
-cc_bool Game_UpdateTexture(GfxResourceID* texId, struct Stream* src, const cc_string* file, cc_uint8* skinType);
+/* decoded is the bitmap already decoded from src, or NULL (see TextureEntry_DecodePng) */
+cc_bool Game_UpdateTexture(GfxResourceID* texId, struct Stream* src, struct Bitmap* decoded, 
+							const cc_string* file, cc_uint8* skinType);
 /* Checks that the given bitmap can be loaded into a native gfx texture. */
 /* (must be power of two size and be <= Gfx_MaxTexWidth/Gfx_MaxHeight) */
 cc_bool Game_ValidateBitmap(const cc_string* file, struct Bitmap* bmp);
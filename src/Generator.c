@@ -10,6 +10,7 @@
 volatile float Gen_CurrentProgress;
 volatile const char* Gen_CurrentState;
 volatile cc_bool Gen_Done;
+volatile cc_bool Gen_Cancelled;
 int Gen_Seed;
 cc_bool Gen_Vanilla;
 BlockRaw* Gen_Blocks;
@@ -143,9 +144,77 @@ static void CombinedNoise_Init(struct CombinedNoise* n, RNGState* rnd, int octav
 	OctaveNoise_Init(&n->noise2, rnd, octaves2);
 }
 
-static float CombinedNoise_Calc(const struct CombinedNoise* n, float x, float y) {
-	float offset = OctaveNoise_Calc(&n->noise2, x, y);
-	return OctaveNoise_Calc(&n->noise1, x + offset, y);
+
+/*########################################################################################################################*
+*------------------------------------------------Batched noise generation-------------------------------------------------*
+*#########################################################################################################################*/
+/* Evaluates noise for up to NOISE_BATCH_SIZE X values along a row with the same Y at once */
+/* Results are exactly the same as calling the single value functions above for each X */
+#define NOISE_BATCH_SIZE 64
+/* Grad(hash, x, y) = noiseGradX[hash] * x + noiseGradY[hash] * y (see xFlags/yFlags above) */
+static const float noiseGradX[16] = { 1,-1, 1,-1, 1,-1, 1,-1, 0, 0, 0, 0, 1, 0,-1, 0 };
+static const float noiseGradY[16] = { 1, 1,-1,-1, 0, 0, 0, 0, 1,-1, 1,-1, 1,-1, 1,-1 };
+
+/* Adds ImprovedNoise_Calc(p, xs[i] * freq, y) * amplitude to sum[i] for each X */
+static void ImprovedNoise_AddBatch(const cc_uint8* p, const float* xs, float freq, float y, 
+									float amplitude, float* sum, int count) {
+	int xFloor, yFloor, X, Y;
+	float x, u, v, gy0[16], gy1[16];
+	int A, B, hash, i;
+	float g22, g12, c1;
+	float g21, g11, c2;
+
+	/* Everything depending only on Y is the same for every X, so is only calculated once */
+	yFloor = y >= 0 ? (int)y : (int)y - 1;
+	Y = yFloor & 0xFF; y -= yFloor;
+	v = y * y * y * (y * (y * 6 - 15) + 10); /* Fade(y) */
+
+	for (i = 0; i < 16; i++) {
+		gy0[i] = noiseGradY[i] * y;
+		gy1[i] = noiseGradY[i] * (y - 1);
+	}
+
+	for (i = 0; i < count; i++) {
+		x = xs[i] * freq;
+		xFloor = x >= 0 ? (int)x : (int)x - 1;
+		X = xFloor & 0xFF; x -= xFloor;
+
+		u = x * x * x * (x * (x * 6 - 15) + 10); /* Fade(x) */
+		A = p[X] + Y; B = p[X + 1] + Y;
+
+		hash = p[p[A]]     & 0xF; g22 = noiseGradX[hash] * x       + gy0[hash];
+		hash = p[p[B]]     & 0xF; g12 = noiseGradX[hash] * (x - 1) + gy0[hash];
+		c1   = g22 + u * (g12 - g22);
+
+		hash = p[p[A + 1]] & 0xF; g21 = noiseGradX[hash] * x       + gy1[hash];
+		hash = p[p[B + 1]] & 0xF; g11 = noiseGradX[hash] * (x - 1) + gy1[hash];
+		c2   = g21 + u * (g11 - g21);
+
+		sum[i] += (c1 + v * (c2 - c1)) * amplitude;
+	}
+}
+
+/* Same as OctaveNoise_Calc(n, xs[i], y) for each X */
+static void OctaveNoise_CalcBatch(const struct OctaveNoise* n, const float* xs, float y, float* sum, int count) {
+	float amplitude = 1, freq = 1;
+	int i;
+	for (i = 0; i < count; i++) { sum[i] = 0; }
+
+	for (i = 0; i < n->octaves; i++) {
+		ImprovedNoise_AddBatch(n->p[i], xs, freq, y * freq, amplitude, sum, count);
+		amplitude *= 2.0f;
+		freq *= 0.5f;
+	}
+}
+
+/* Calculates noise1(x + noise2(x, y), y) for each X */
+static void CombinedNoise_CalcBatch(const struct CombinedNoise* n, const float* xs, float y, float* sum, int count) {
+	float offset[NOISE_BATCH_SIZE];
+	int i;
+	OctaveNoise_CalcBatch(&n->noise2, xs, y, offset, count);
+
+	for (i = 0; i < count; i++) { offset[i] += xs[i]; }
+	OctaveNoise_CalcBatch(&n->noise1, offset, y, sum, count);
 }
 
 
@@ -156,13 +225,14 @@ static int waterLevel, minHeight;
 static cc_int16* Heightmap;
 static RNGState rnd;
 
-static void NotchyGen_FillOblateSpheroid(int x, int y, int z, float radius, BlockRaw block) {
+/* Only fills in the part of the spheroid between zMin and zMax (inclusive) */
+static void NotchyGen_FillOblateSpheroid(int x, int y, int z, float radius, BlockRaw block, int zMin, int zMax) {
 	int xBeg = Math_Floor(max(x - radius, 0));
 	int xEnd = Math_Floor(min(x + radius, World.MaxX));
 	int yBeg = Math_Floor(max(y - radius, 0));
 	int yEnd = Math_Floor(min(y + radius, World.MaxY));
-	int zBeg = Math_Floor(max(z - radius, 0));
-	int zEnd = Math_Floor(min(z + radius, World.MaxZ));
+	int zBeg = Math_Floor(max(z - radius, zMin));
+	int zEnd = Math_Floor(min(z + radius, zMax));
 
 	float radiusSq = radius * radius;
 	int index;
@@ -182,76 +252,183 @@ static void NotchyGen_FillOblateSpheroid(int x, int y, int z, float radius, Bloc
 	}
 }
 
-#define STACK_FAST 8192
-static void NotchyGen_FloodFill(int index, BlockRaw block) {
-	int* stack;
-	int stack_default[STACK_FAST]; /* avoid allocating memory if possible */
-	int count = 0, limit = STACK_FAST;
-	int x, y, z;
+/* Filling spheroids only ever replaces stone with the same block, so the order they are */
+/*  filled in does not matter. Caves and ore veins are still walked in order using the shared */
+/*  RNG (so maps stay the same for a given seed), but the spheroids along the walks are */
+/*  queued up and then filled in parallel, with each job doing a slab of Z rows */
+#ifdef CC_BUILD_LOWMEM
+#define NOTCHY_MAX_SPHEROIDS 512
+#else
+#define NOTCHY_MAX_SPHEROIDS 16384
+#endif
+#define NOTCHY_SPHEROID_JOBS 16
+
+struct NotchySpheroid { int x, y, z; float radius; };
+struct SpheroidQueue {
+	struct NotchySpheroid all[NOTCHY_MAX_SPHEROIDS];
+	int count;
+	BlockRaw block;
+};
+
+static void NotchyGen_FillSpheroidsSlab(void* obj, int job) {
+	struct SpheroidQueue* queue = (struct SpheroidQueue*)obj;
+	struct NotchySpheroid* s    = queue->all;
+	int zMin = World.Length * job       / NOTCHY_SPHEROID_JOBS;
+	int zMax = World.Length * (job + 1) / NOTCHY_SPHEROID_JOBS - 1;
+	int i;
+
+	for (i = 0; i < queue->count; i++, s++) {
+		if (s->z + s->radius < zMin || s->z - s->radius > zMax + 1) continue;
+		NotchyGen_FillOblateSpheroid(s->x, s->y, s->z, s->radius, queue->block, zMin, zMax);
+	}
+}
+
+static void NotchyGen_FlushSpheroids(struct SpheroidQueue* queue) {
+	Utils_ParallelFor(NotchyGen_FillSpheroidsSlab, queue, NOTCHY_SPHEROID_JOBS);
+	queue->count = 0;
+}
 
-	stack = stack_default;
-	if (index < 0) return; /* y below map, don't bother starting */
-	stack[count++] = index;
+static void NotchyGen_QueueSpheroid(struct SpheroidQueue* queue, int x, int y, int z, float radius) {
+	struct NotchySpheroid* s;
+	if (queue->count == NOTCHY_MAX_SPHEROIDS) NotchyGen_FlushSpheroids(queue);
 
-	while (count) {
-		index = stack[--count];
+	s = &queue->all[queue->count++];
+	s->x = x; s->y = y; s->z = z; s->radius = radius;
+}
 
-		if (Gen_Blocks[index] != BLOCK_AIR) continue;
-		Gen_Blocks[index] = block;
+/* Floods air blocks connected along X, along Z and downwards, one run of blocks along X at a time. */
+/* Filled blocks are no longer air, so the map itself keeps track of which runs have been visited */
+#define FLOOD_STACK_FAST 1024
+struct FloodSeed  { int x, y, z; };
+struct FloodStack { struct FloodSeed* seeds; int count, limit; };
 
-		x = index  % World.Width;
-		y = index  / World.OneY;
-		z = (index / World.Width) % World.Length;
+/* Queues up a seed for each run of air blocks in the given row between x1 and x2 */
+static void NotchyGen_FloodRow(struct FloodStack* stack, int x1, int x2, int y, int z) {
+	BlockRaw* row = Gen_Blocks + World_Pack(0, y, z);
+	struct FloodSeed* seed;
+	int x;
 
-		/* need to increase stack */
-		if (count >= limit - FACE_COUNT) {
-			Utils_Resize((void**)&stack, &limit, 4, STACK_FAST, STACK_FAST);
+	for (x = x1; x <= x2; x++) {
+		if (row[x] != BLOCK_AIR) continue;
+
+		if (stack->count == stack->limit) {
+			Utils_Resize((void**)&stack->seeds, &stack->limit, 
+				sizeof(struct FloodSeed), FLOOD_STACK_FAST, FLOOD_STACK_FAST);
 		}
+		seed = &stack->seeds[stack->count++];
+		seed->x = x; seed->y = y; seed->z = z;
 
-		if (x > 0)          { stack[count++] = index - 1; }
-		if (x < World.MaxX) { stack[count++] = index + 1; }
-		if (z > 0)          { stack[count++] = index - World.Width; }
-		if (z < World.MaxZ) { stack[count++] = index + World.Width; }
-		if (y > 0)          { stack[count++] = index - World.OneY; }
+		/* The rest of this run gets filled from the seed */
+		while (x < x2 && row[x + 1] == BLOCK_AIR) x++;
 	}
-	if (limit > STACK_FAST) Mem_Free(stack);
 }
 
+static void NotchyGen_FloodFill(int x, int y, int z, BlockRaw block) {
+	struct FloodSeed stack_default[FLOOD_STACK_FAST]; /* avoid allocating memory if possible */
+	struct FloodStack stack;
+	BlockRaw* row;
+	int x1, x2;
+
+	if (y < 0) return; /* y below map, don't bother starting */
+	stack.seeds = stack_default;
+	stack.count = 1;
+	stack.limit = FLOOD_STACK_FAST;
+	stack_default[0].x = x; stack_default[0].y = y; stack_default[0].z = z;
+
+	while (stack.count) {
+		stack.count--;
+		x = stack.seeds[stack.count].x;
+		y = stack.seeds[stack.count].y;
+		z = stack.seeds[stack.count].z;
+
+		row = Gen_Blocks + World_Pack(0, y, z);
+		if (row[x] != BLOCK_AIR) continue;
+
+		/* Extend to the whole run of air along X, then fill it in one go */
+		for (x1 = x; x1 > 0          && row[x1 - 1] == BLOCK_AIR; x1--) { }
+		for (x2 = x; x2 < World.MaxX && row[x2 + 1] == BLOCK_AIR; x2++) { }
+		Mem_Set(row + x1, block, x2 - x1 + 1);
+
+		if (z > 0)          NotchyGen_FloodRow(&stack, x1, x2, y, z - 1);
+		if (z < World.MaxZ) NotchyGen_FloodRow(&stack, x1, x2, y, z + 1);
+		if (y > 0)          NotchyGen_FloodRow(&stack, x1, x2, y - 1, z);
+	}
+	if (stack.limit > FLOOD_STACK_FAST) Mem_Free(stack.seeds);
+}
 
-static void NotchyGen_CreateHeightmap(void) {
-	float hLow, hHigh, height;
-	int hIndex = 0, adjHeight;
-	int x, z;
-	struct CombinedNoise n1, n2;
-	struct OctaveNoise n3;
 
-	CombinedNoise_Init(&n1, &rnd, 8, 8);
-	CombinedNoise_Init(&n2, &rnd, 8, 8);	
-	OctaveNoise_Init(&n3, &rnd, 6);
+/* Each X/Z column of the heightmap and strata is independent of all the others, */
+/*  so these are calculated in parallel, with each job doing a few rows of columns */
+#define NOTCHY_ROWS_PER_JOB 8
+#define NotchyGen_RowJobs() ((World.Length + NOTCHY_ROWS_PER_JOB - 1) / NOTCHY_ROWS_PER_JOB)
 
-	Gen_CurrentState = "Building heightmap";
-	for (z = 0; z < World.Length; z++) {
-		Gen_CurrentProgress = (float)z / World.Length;
+struct HeightmapNoise { struct CombinedNoise n1, n2; struct OctaveNoise n3; };
 
-		for (x = 0; x < World.Width; x++) {
-			hLow   = CombinedNoise_Calc(&n1, x * 1.3f, z * 1.3f) / 6 - 4;
-			height = hLow;
+static void NotchyGen_HeightmapRows(void* obj, int job) {
+	struct HeightmapNoise* noise = (struct HeightmapNoise*)obj;
+	int zBeg = job * NOTCHY_ROWS_PER_JOB;
+	int zEnd = min(zBeg + NOTCHY_ROWS_PER_JOB, World.Length);
+	int hIndex = zBeg * World.Width;
+	float xs[NOISE_BATCH_SIZE], lows[NOISE_BATCH_SIZE];
+	float xs3[NOISE_BATCH_SIZE], sel[NOISE_BATCH_SIZE];
+	float xs2[NOISE_BATCH_SIZE], highs[NOISE_BATCH_SIZE];
+	float hLow, hHigh, height;
+	int x, z, i, j, count, highCount;
+
+	if (Gen_Cancelled) return;
+	/* Jobs are started in order, so this is close enough to overall progress */
+	Gen_CurrentProgress = (float)zBeg / World.Length;
+
+	for (z = zBeg; z < zEnd; z++) {
+		for (x = 0; x < World.Width; x += count) {
+			count = min(NOISE_BATCH_SIZE, World.Width - x);
+			for (i = 0; i < count; i++) {
+				xs[i]  = (x + i) * 1.3f;
+				xs3[i] = (float)(x + i);
+			}
+
+			CombinedNoise_CalcBatch(&noise->n1, xs,  z * 1.3f, lows, count);
+			OctaveNoise_CalcBatch(&noise->n3,   xs3, (float)z, sel,  count);
 
-			if (OctaveNoise_Calc(&n3, (float)x, (float)z) <= 0) {
-				hHigh = CombinedNoise_Calc(&n2, x * 1.3f, z * 1.3f) / 5 + 6;
-				height = max(hLow, hHigh);
+			/* Only columns where the selector noise is <= 0 need the high noise */
+			for (i = 0, highCount = 0; i < count; i++) {
+				if (sel[i] <= 0) xs2[highCount++] = xs[i];
 			}
+			CombinedNoise_CalcBatch(&noise->n2, xs2, z * 1.3f, highs, highCount);
 
-			height *= 0.5f;
-			if (height < 0) height *= 0.8f;
+			for (i = 0, j = 0; i < count; i++) {
+				hLow   = lows[i] / 6 - 4;
+				height = hLow;
 
-			adjHeight = (int)(height + waterLevel);
-			minHeight = min(adjHeight, minHeight);
-			Heightmap[hIndex++] = adjHeight;
+				if (sel[i] <= 0) {
+					hHigh  = highs[j++] / 5 + 6;
+					height = max(hLow, hHigh);
+				}
+
+				height *= 0.5f;
+				if (height < 0) height *= 0.8f;
+				Heightmap[hIndex++] = (int)(height + waterLevel);
+			}
 		}
 	}
 }
 
+static void NotchyGen_CreateHeightmap(void) {
+	struct HeightmapNoise noise;
+	int i, count = World.Width * World.Length;
+
+	CombinedNoise_Init(&noise.n1, &rnd, 8, 8);
+	CombinedNoise_Init(&noise.n2, &rnd, 8, 8);	
+	OctaveNoise_Init(&noise.n3, &rnd, 6);
+
+	Gen_CurrentState = "Building heightmap";
+	Utils_ParallelFor(NotchyGen_HeightmapRows, &noise, NotchyGen_RowJobs());
+
+	for (i = 0; i < count; i++) {
+		minHeight = min(Heightmap[i], minHeight);
+	}
+}
+
 static int NotchyGen_CreateStrataFast(void) {
 	cc_uint32 oneY = (cc_uint32)World.OneY;
 	int stoneHeight, airHeight;
@@ -281,23 +458,35 @@ static int NotchyGen_CreateStrataFast(void) {
 	return max(stoneHeight, 1);
 }
 
-static void NotchyGen_CreateStrata(void) {
-	int dirtThickness, dirtHeight;
-	int minStoneY, stoneHeight;
-	int hIndex = 0, maxY = World.MaxY, index = 0;
-	int x, y, z;
-	struct OctaveNoise n;
+struct StrataNoise { struct OctaveNoise n; int minStoneY; };
 
-	/* Try to bulk fill bottom of the map if possible */
-	minStoneY = NotchyGen_CreateStrataFast();
-	OctaveNoise_Init(&n, &rnd, 8);
+static void NotchyGen_StrataRows(void* obj, int job) {
+	struct StrataNoise* noise = (struct StrataNoise*)obj;
+	int zBeg = job * NOTCHY_ROWS_PER_JOB;
+	int zEnd = min(zBeg + NOTCHY_ROWS_PER_JOB, World.Length);
+	int hIndex = zBeg * World.Width;
+	int minStoneY = noise->minStoneY;
+	int dirtThickness, dirtHeight, stoneHeight;
+	int maxY = World.MaxY, index;
+	float xs[NOISE_BATCH_SIZE], thickness[NOISE_BATCH_SIZE];
+	int x, y, z, i, count = 0;
 
-	Gen_CurrentState = "Creating strata";
-	for (z = 0; z < World.Length; z++) {
-		Gen_CurrentProgress = (float)z / World.Length;
+	if (Gen_Cancelled) return;
+	Gen_CurrentProgress = (float)zBeg / World.Length;
 
+	for (z = zBeg; z < zEnd; z++) {
 		for (x = 0; x < World.Width; x++) {
-			dirtThickness = (int)(OctaveNoise_Calc(&n, (float)x, (float)z) / 24 - 4);
+			/* Calculate noise for the next batch of columns along this row */
+			i = x % NOISE_BATCH_SIZE;
+			if (i == 0) {
+				count = min(NOISE_BATCH_SIZE, World.Width - x);
+				for (i = 0; i < count; i++) { xs[i] = (float)(x + i); }
+
+				OctaveNoise_CalcBatch(&noise->n, xs, (float)z, thickness, count);
+				i = 0;
+			}
+
+			dirtThickness = (int)(thickness[i] / 24 - 4);
 			dirtHeight    = Heightmap[hIndex++];
 			stoneHeight   = dirtHeight + dirtThickness;
 
@@ -318,6 +507,17 @@ static void NotchyGen_CreateStrata(void) {
 	}
 }
 
+static void NotchyGen_CreateStrata(void) {
+	struct StrataNoise noise;
+
+	/* Try to bulk fill bottom of the map if possible */
+	noise.minStoneY = NotchyGen_CreateStrataFast();
+	OctaveNoise_Init(&noise.n, &rnd, 8);
+
+	Gen_CurrentState = "Creating strata";
+	Utils_ParallelFor(NotchyGen_StrataRows, &noise, NotchyGen_RowJobs());
+}
+
 static void NotchyGen_CarveCaves(void) {
 	int cavesCount, caveLen;
 	float caveX, caveY, caveZ;
@@ -325,10 +525,15 @@ static void NotchyGen_CarveCaves(void) {
 	float caveRadius, radius;
 	int cenX, cenY, cenZ;
 	int i, j;
+	struct SpheroidQueue* queue;
+
+	queue = (struct SpheroidQueue*)Mem_Alloc(1, sizeof(struct SpheroidQueue), "spheroid queue");
+	queue->count = 0;
+	queue->block = BLOCK_AIR;
 
 	cavesCount       = World.Volume / 8192;
 	Gen_CurrentState = "Carving caves";
-	for (i = 0; i < cavesCount; i++) {
+	for (i = 0; i < cavesCount && !Gen_Cancelled; i++) {
 		Gen_CurrentProgress = (float)i / cavesCount;
 
 		caveX = (float)Random_Next(&rnd, World.Width);
@@ -358,9 +563,12 @@ static void NotchyGen_CarveCaves(void) {
 			radius = (World.Height - cenY) / (float)World.Height;
 			radius = 1.2f + (radius * 3.5f + 1.0f) * caveRadius;
 			radius = radius * Math_SinF(j * MATH_PI / caveLen);
-			NotchyGen_FillOblateSpheroid(cenX, cenY, cenZ, radius, BLOCK_AIR);
+			NotchyGen_QueueSpheroid(queue, cenX, cenY, cenZ, radius);
 		}
 	}
+
+	NotchyGen_FlushSpheroids(queue);
+	Mem_Free(queue);
 }
 
 static void NotchyGen_CarveOreVeins(float abundance, const char* state, BlockRaw block) {
@@ -369,6 +577,11 @@ static void NotchyGen_CarveOreVeins(float abundance, const char* state, BlockRaw
 	float theta, deltaTheta, phi, deltaPhi;
 	float radius;
 	int i, j;
+	struct SpheroidQueue* queue;
+
+	queue = (struct SpheroidQueue*)Mem_Alloc(1, sizeof(struct SpheroidQueue), "spheroid queue");
+	queue->count = 0;
+	queue->block = block;
 
 	numVeins         = (int)(World.Volume * abundance / 16384);
 	Gen_CurrentState = state;
@@ -394,35 +607,31 @@ static void NotchyGen_CarveOreVeins(float abundance, const char* state, BlockRaw
 			deltaPhi   = deltaPhi   * 0.9f + Random_Float(&rnd) - Random_Float(&rnd);
 
 			radius = abundance * Math_SinF(j * MATH_PI / veinLen) + 1.0f;
-			NotchyGen_FillOblateSpheroid((int)veinX, (int)veinY, (int)veinZ, radius, block);
+			NotchyGen_QueueSpheroid(queue, (int)veinX, (int)veinY, (int)veinZ, radius);
 		}
 	}
+
+	NotchyGen_FlushSpheroids(queue);
+	Mem_Free(queue);
 }
 
 static void NotchyGen_FloodFillWaterBorders(void) {
 	int waterY = waterLevel - 1;
-	int index1, index2;
 	int x, z;
 	Gen_CurrentState = "Flooding edge water";
 
-	index1 = World_Pack(0, waterY, 0);
-	index2 = World_Pack(0, waterY, World.Length - 1);
 	for (x = 0; x < World.Width; x++) {
 		Gen_CurrentProgress = 0.0f + ((float)x / World.Width) * 0.5f;
 
-		NotchyGen_FloodFill(index1, BLOCK_STILL_WATER);
-		NotchyGen_FloodFill(index2, BLOCK_STILL_WATER);
-		index1++; index2++;
+		NotchyGen_FloodFill(x, waterY, 0,            BLOCK_STILL_WATER);
+		NotchyGen_FloodFill(x, waterY, World.MaxZ,   BLOCK_STILL_WATER);
 	}
 
-	index1 = World_Pack(0,             waterY, 0);
-	index2 = World_Pack(World.Width - 1, waterY, 0);
 	for (z = 0; z < World.Length; z++) {
 		Gen_CurrentProgress = 0.5f + ((float)z / World.Length) * 0.5f;
 
-		NotchyGen_FloodFill(index1, BLOCK_STILL_WATER);
-		NotchyGen_FloodFill(index2, BLOCK_STILL_WATER);
-		index1 += World.Width; index2 += World.Width;
+		NotchyGen_FloodFill(0,          waterY, z, BLOCK_STILL_WATER);
+		NotchyGen_FloodFill(World.MaxX, waterY, z, BLOCK_STILL_WATER);
 	}
 }
 
@@ -438,7 +647,7 @@ static void NotchyGen_FloodFillWater(void) {
 		x = Random_Next(&rnd, World.Width);
 		z = Random_Next(&rnd, World.Length);
 		y = waterLevel - Random_Range(&rnd, 1, 3);
-		NotchyGen_FloodFill(World_Pack(x, y, z), BLOCK_STILL_WATER);
+		NotchyGen_FloodFill(x, y, z, BLOCK_STILL_WATER);
 	}
 }
 
@@ -454,7 +663,7 @@ static void NotchyGen_FloodFillLava(void) {
 		x = Random_Next(&rnd, World.Width);
 		z = Random_Next(&rnd, World.Length);
 		y = (int)((waterLevel - 3) * Random_Float(&rnd) * Random_Float(&rnd));
-		NotchyGen_FloodFill(World_Pack(x, y, z), BLOCK_STILL_LAVA);
+		NotchyGen_FloodFill(x, y, z, BLOCK_STILL_LAVA);
 	}
 }
 
@@ -468,7 +677,7 @@ static void NotchyGen_CreateSurfaceLayer(void) {
 	OctaveNoise_Init(&n2, &rnd, 8);
 
 	Gen_CurrentState = "Creating surface";
-	for (z = 0; z < World.Length; z++) {
+	for (z = 0; z < World.Length && !Gen_Cancelled; z++) {
 		Gen_CurrentProgress = (float)z / World.Length;
 
 		for (x = 0; x < World.Width; x++) {
@@ -620,26 +829,24 @@ void Log(const char*str) {
 void Log(const char*) {}
 #endif
 
-void NotchyGen_Generate(void) {
-	Gen_Init();
-	Heightmap = (cc_int16*)Mem_Alloc(World.Width * World.Length, 2, "gen heightmap");
-
-	Random_Seed(&rnd, Gen_Seed);
-	waterLevel = World.Height / 2;	
-	minHeight  = World.Height;
-
+/* Performs each step of generation in order, stopping early if generation is cancelled */
+static void NotchyGen_Run(void) {
 	Log("Heightmap");
 	NotchyGen_CreateHeightmap();
+	if (Gen_Cancelled) return;
 	Log("Creating strata");
 	NotchyGen_CreateStrata();
+	if (Gen_Cancelled) return;
 	Log("Carving");
 	NotchyGen_CarveCaves();
+	if (Gen_Cancelled) return;
 	Log("Creating coal ores");
 	NotchyGen_CarveOreVeins(0.9f, "Carving coal ore", BLOCK_COAL_ORE);
 	Log("Creating iron ores");
 	NotchyGen_CarveOreVeins(0.7f, "Carving iron ore", BLOCK_IRON_ORE);
 	Log("Creating gold ores");
 	NotchyGen_CarveOreVeins(0.5f, "Carving gold ore", BLOCK_GOLD_ORE);
+	if (Gen_Cancelled) return;
 
 	Log("Flooding Water Borders");
 	NotchyGen_FloodFillWaterBorders();
@@ -647,9 +854,11 @@ void NotchyGen_Generate(void) {
 	NotchyGen_FloodFillWater();
 	Log("Flooding Lava");
 	NotchyGen_FloodFillLava();
+	if (Gen_Cancelled) return;
 
 	Log("Creating Surface");
 	NotchyGen_CreateSurfaceLayer();
+	if (Gen_Cancelled) return;
 	Log("Planting Flowers");
 	NotchyGen_PlantFlowers();
 	Log("Planting Mushrooms");
@@ -657,7 +866,17 @@ void NotchyGen_Generate(void) {
 	Log("Planting Trees");
 	NotchyGen_PlantTrees();
 	Log("Generation Done !");
+}
+
+void NotchyGen_Generate(void) {
+	Gen_Init();
+	Heightmap = (cc_int16*)Mem_Alloc(World.Width * World.Length, 2, "gen heightmap");
+
+	Random_Seed(&rnd, Gen_Seed);
+	waterLevel = World.Height / 2;	
+	minHeight  = World.Height;
 
+	NotchyGen_Run();
 	Mem_Free(Heightmap);
 	Heightmap = NULL;
 	Gen_Done  = true;
@@ -14,10 +14,15 @@ extern volatile float Gen_CurrentProgress;
 extern volatile const char* Gen_CurrentState;
 /* Whether map generation has completed */
 extern volatile cc_bool Gen_Done;
+/* Whether map generation should stop as soon as possible */
+/* NOTE: Gen_Blocks is left only partially generated when this happens */
+extern volatile cc_bool Gen_Cancelled;
 extern int Gen_Seed;
 extern cc_bool Gen_Vanilla;
 extern BlockRaw* Gen_Blocks;
 
+/* NOTE: These only read World dimensions and write to Gen_Blocks, */
+/*  so can be safely run on a background thread while World is not loaded */
 void FlatgrassGen_Generate(void);
 void NotchyGen_Generate(void);
 
@@ -205,8 +205,10 @@ void Gfx_CalcPerspectiveMatrix(struct Matrix* matrix, float fov, float aspect, f
 /* NOTE: Projection matrix calculation is here because it can depend the graphics backend */
 /*  (e.g. OpenGL uses a Z clip space range of [-1, 1], whereas Direct3D9 uses [0, 1]) */
 
-/* Outputs a .png screenshot of the backbuffer */
-cc_result Gfx_TakeScreenshot(struct Stream* output);
+/* Copies the contents of the backbuffer into a newly allocated bitmap */
+/* bottomUp is set to true when the rows are ordered bottom to top, instead of top to bottom */
+/* NOTE: The bitmap's pixels must be freed using Mem_Free once done with */
+cc_result Gfx_TakeScreenshot(struct Bitmap* bmp, cc_bool* bottomUp);
 /* Warns in chat if the backend has problems with the user's GPU */
 /* Returns whether legacy rendering mode for borders/sky/clouds is needed */
 cc_bool Gfx_WarnIfNecessary(void);
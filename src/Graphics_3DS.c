@@ -333,7 +333,7 @@ void Gfx_SetColWriteMask(cc_bool r, cc_bool g, cc_bool b, cc_bool a) {
 /*########################################################################################################################*
 *-----------------------------------------------------------Misc----------------------------------------------------------*
 *#########################################################################################################################*/
-cc_result Gfx_TakeScreenshot(struct Stream* output) {
+cc_result Gfx_TakeScreenshot(struct Bitmap* bmp, cc_bool* bottomUp) {
 	return ERR_NOT_SUPPORTED;
 }
 
@@ -1051,21 +1051,10 @@ void Gfx_DepthOnlyRendering(cc_bool depthOnly) {
 /*########################################################################################################################*
 *-----------------------------------------------------------Misc----------------------------------------------------------*
 *#########################################################################################################################*/
-static BitmapCol* D3D11_GetRow(struct Bitmap* bmp, int y) {
-	// You were expecting a BitmapCol*, but it was me, D3D11_MAPPED_SUBRESOURCE*!
-	//  This is necessary because the stride of the mapped backbuffer often doesn't equal width of the bitmap
-	//    e.g. with backbuffer width of 854, stride is 3456 bytes instead of expected 3416 (854*4)
-	//  Therefore have to calculate row address manually instead of using Bitmap_GetRow
-	D3D11_MAPPED_SUBRESOURCE* buffer = (D3D11_MAPPED_SUBRESOURCE*)bmp->scan0;
-
-	char* row = (char*)buffer->pData + y * buffer->RowPitch;
-	return (BitmapCol*)row;
-}
-
-cc_result Gfx_TakeScreenshot(struct Stream* output) {
+cc_result Gfx_TakeScreenshot(struct Bitmap* bmp, cc_bool* bottomUp) {
 	ID3D11Texture2D* tmp = NULL;
-	struct Bitmap bmp;
 	HRESULT hr;
+	int y;
 
 	ID3D11Resource* backbuffer_res;
 	D3D11_RENDER_TARGET_VIEW_DESC backbuffer_desc;
@@ -1090,8 +1079,20 @@ cc_result Gfx_TakeScreenshot(struct Stream* output) {
 	hr = ID3D11DeviceContext_Map(context, tmp, 0, D3D11_MAP_READ, 0, &buffer);
 	if (hr) goto finished;
 	{
-		Bitmap_Init(bmp, desc.Width, desc.Height, (BitmapCol*)&buffer);
-		hr = Png_Encode(&bmp, output, D3D11_GetRow, false);
+		bmp->width  = desc.Width;
+		bmp->height = desc.Height;
+		bmp->scan0  = (BitmapCol*)Mem_TryAlloc(bmp->width * bmp->height, 4);
+
+		// The stride of the mapped backbuffer often doesn't equal width of the bitmap
+		//  e.g. with backbuffer width of 854, stride is 3456 bytes instead of expected 3416 (854*4)
+		//  Therefore have to copy each row separately
+		if (bmp->scan0) {
+			for (y = 0; y < bmp->height; y++) {
+				Mem_Copy(Bitmap_GetRow(bmp, y), (char*)buffer.pData + y * buffer.RowPitch, bmp->width * 4);
+			}
+		} else {
+			hr = ERR_OUT_OF_MEMORY;
+		}
 	}
 	ID3D11DeviceContext_Unmap(context, tmp, 0);
 
@@ -791,13 +791,13 @@ void Gfx_CalcPerspectiveMatrix(struct Matrix* matrix, float fov, float aspect, f
 /*########################################################################################################################*
 *-----------------------------------------------------------Misc----------------------------------------------------------*
 *#########################################################################################################################*/
-cc_result Gfx_TakeScreenshot(struct Stream* output) {
+cc_result Gfx_TakeScreenshot(struct Bitmap* bmp, cc_bool* bottomUp) {
 	IDirect3DSurface9* backbuffer = NULL;
 	IDirect3DSurface9* temp = NULL;
 	D3DSURFACE_DESC desc;
 	D3DLOCKED_RECT rect;
-	struct Bitmap bmp;
 	cc_result res;
+	int y;
 
 	res = IDirect3DDevice9_GetBackBuffer(device, 0, 0, D3DBACKBUFFER_TYPE_MONO, &backbuffer);
 	if (res) goto finished;
@@ -812,9 +812,14 @@ cc_result Gfx_TakeScreenshot(struct Stream* output) {
 	res = IDirect3DSurface9_LockRect(temp, &rect, NULL, D3DLOCK_READONLY | D3DLOCK_NO_DIRTY_UPDATE);
 	if (res) goto finished;
 	{
-		Bitmap_Init(bmp, desc.Width, desc.Height, (BitmapCol*)rect.pBits);
-		res = Png_Encode(&bmp, output, NULL, false);
-		if (res) { IDirect3DSurface9_UnlockRect(temp); goto finished; }
+		bmp->width  = desc.Width;
+		bmp->height = desc.Height;
+		bmp->scan0  = (BitmapCol*)Mem_TryAlloc(bmp->width * bmp->height, 4);
+		if (!bmp->scan0) { IDirect3DSurface9_UnlockRect(temp); res = ERR_OUT_OF_MEMORY; goto finished; }
+
+		for (y = 0; y < bmp->height; y++) {
+			Mem_Copy(Bitmap_GetRow(bmp, y), (cc_uint8*)rect.pBits + y * rect.Pitch, bmp->width * 4);
+		}
 	}
 	res = IDirect3DSurface9_UnlockRect(temp);
 	if (res) goto finished;
@@ -504,7 +504,7 @@ void Gfx_DrawIndexedTris_T2fC4b(int verticesCount, int startVertex) {
 /*########################################################################################################################*
 *-----------------------------------------------------------Misc----------------------------------------------------------*
 *#########################################################################################################################*/
-cc_result Gfx_TakeScreenshot(struct Stream* output) {
+cc_result Gfx_TakeScreenshot(struct Bitmap* bmp, cc_bool* bottomUp) {
 	return ERR_NOT_SUPPORTED;
 }
 
@@ -235,7 +235,7 @@ void Gfx_SetDepthTest(cc_bool enabled) {
 /*########################################################################################################################*
 *-----------------------------------------------------------Misc----------------------------------------------------------*
 *#########################################################################################################################*/
-cc_result Gfx_TakeScreenshot(struct Stream* output) {
+cc_result Gfx_TakeScreenshot(struct Bitmap* bmp, cc_bool* bottomUp) {
 	return ERR_NOT_SUPPORTED;
 }
 
@@ -54,7 +54,7 @@ void Gfx_Free(void) {
 *#########################################################################################################################*/
 //static color_t gfx_clearColor;
 
-cc_result Gfx_TakeScreenshot(struct Stream* output) {
+cc_result Gfx_TakeScreenshot(struct Bitmap* bmp, cc_bool* bottomUp) {
 	return ERR_NOT_SUPPORTED;
 }
 
@@ -530,23 +530,23 @@ void Screen_PointerUp(void* s, int id, int x, int y) { }
 /*########################################################################################################################*
 *------------------------------------------------------Gui component------------------------------------------------------*
 *#########################################################################################################################*/
-static void GuiPngProcess(struct Stream* stream, const cc_string* name) {
-	Game_UpdateTexture(&Gui.GuiTex, stream, name, NULL);
+static void GuiPngProcess(struct Stream* stream, const cc_string* name, struct Bitmap* decoded) {
+	Game_UpdateTexture(&Gui.GuiTex, stream, decoded, name, NULL);
 }
 static struct TextureEntry gui_entry = { "gui.png", GuiPngProcess };
 
-static void GuiClassicPngProcess(struct Stream* stream, const cc_string* name) {
-	Game_UpdateTexture(&Gui.GuiClassicTex, stream, name, NULL);
+static void GuiClassicPngProcess(struct Stream* stream, const cc_string* name, struct Bitmap* decoded) {
+	Game_UpdateTexture(&Gui.GuiClassicTex, stream, decoded, name, NULL);
 }
 static struct TextureEntry guiClassic_entry = { "gui_classic.png", GuiClassicPngProcess };
 
-static void IconsPngProcess(struct Stream* stream, const cc_string* name) {
-	Game_UpdateTexture(&Gui.IconsTex, stream, name, NULL);
+static void IconsPngProcess(struct Stream* stream, const cc_string* name, struct Bitmap* decoded) {
+	Game_UpdateTexture(&Gui.IconsTex, stream, decoded, name, NULL);
 }
 static struct TextureEntry icons_entry = { "icons.png", IconsPngProcess };
 
-static void TouchPngProcess(struct Stream* stream, const cc_string* name) {
-	Game_UpdateTexture(&Gui.TouchTex, stream, name, NULL);
+static void TouchPngProcess(struct Stream* stream, const cc_string* name, struct Bitmap* decoded) {
+	Game_UpdateTexture(&Gui.TouchTex, stream, decoded, name, NULL);
 }
 static struct TextureEntry touch_entry = { "touch.png", TouchPngProcess };
 
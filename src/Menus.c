@@ -1369,13 +1369,31 @@ static void SaveLevelScreen_RemoveOverwrites(struct SaveLevelScreen* s) {
 static cc_result SaveLevelScreen_SaveMap(const cc_string* path) {
 	static const cc_string schematic = String_FromConst(".schematic");
 	static const cc_string mine = String_FromConst(".mine");
+	static const cc_string cwr  = String_FromConst(".cwr");
 	struct Stream stream, compStream;
-	struct GZipState state;
+	struct GZipParallelState state;
+	cc_bool classicWorld;
 	cc_result res;
 
+	/* Region maps aren't a single compressed stream, so are written separately */
+	if (String_CaselessEnds(path, &cwr)) {
+		res = Cwr_Save(path);
+		if (res) { Logger_SysWarn2(res, "saving", path); return res; }
+
+		World.LastSave = Game.Time;
+		Gui_ShowPauseMenu();
+		return 0;
+	}
+
+	classicWorld = !String_CaselessEnds(path, &schematic) && !String_CaselessEnds(path, &mine);
+	if (classicWorld) Cw_BeginSave(path);
+
 	res = Stream_CreateFile(&stream, path);
-	if (res) { Logger_SysWarn2(res, "creating", path); return res; }
-	GZip_MakeStream(&compStream, &state, &stream);
+	if (res) {
+		if (classicWorld) Cw_EndSave(res);
+		Logger_SysWarn2(res, "creating", path); return res;
+	}
+	GZip_MakeParallelStream(&compStream, &state, &stream, DEFLATE_LEVEL_DEFAULT);
 
 	if (String_CaselessEnds(path, &schematic)) {
 		res = Schematic_Save(&compStream);
@@ -1386,16 +1404,20 @@ static cc_result SaveLevelScreen_SaveMap(const cc_string* path) {
 	}
 
 	if (res) {
+		GZip_FreeParallelStream(&state);
 		stream.Close(&stream);
+		if (classicWorld) Cw_EndSave(res);
 		Logger_SysWarn2(res, "encoding", path); return res;
 	}
 
 	if ((res = compStream.Close(&compStream))) {
 		stream.Close(&stream);
+		if (classicWorld) Cw_EndSave(res);
 		Logger_SysWarn2(res, "closing", path); return res;
 	}
 
 	res = stream.Close(&stream);
+	if (classicWorld) Cw_EndSave(res);
 	if (res) { Logger_SysWarn2(res, "closing", path); return res; }
 
 	World.LastSave = Game.Time;
@@ -1426,10 +1448,18 @@ static void SaveLevelScreen_Save(void* screen, void* widget) {
 	}
 		
 	SaveLevelScreen_RemoveOverwrites(s);
+	/* Fallback to saving on the main thread if can't save in the background */
+	if (!Cw_SaveInBackground(&path)) {
+		World.LastSave = Game.Time;
+		Gui_ShowPauseMenu();
+		return;
+	}
+
 	if ((res = SaveLevelScreen_SaveMap(&path))) return;
 	Chat_Add1("&eSaved map to: %s", &path);
 }
 
+/* NOTE: The map must be saved immediately, as it may be used right after the callback */
 static void SaveLevelScreen_UploadCallback(const cc_string* path) {
 	cc_result res = SaveLevelScreen_SaveMap(path);
 	if (!res) Chat_Add1("&eSaved map to: %s", path);
@@ -1437,10 +1467,10 @@ static void SaveLevelScreen_UploadCallback(const cc_string* path) {
 
 static void SaveLevelScreen_File(void* screen, void* b) {
 	static const char* const titles[] = {
-		"ClassiCube map", "Minecraft schematic", "Minecraft classic map", NULL
+		"ClassiCube map", "Minecraft schematic", "Minecraft classic map", "ClassiCube region map", NULL
 	};
 	static const char* const filters[] = {
-		".cw", ".schematic", ".mine", NULL
+		".cw", ".schematic", ".mine", ".cwr", NULL
 	};
 	struct SaveLevelScreen* s = (struct SaveLevelScreen*)screen;
 	struct SaveFileDialogArgs args;
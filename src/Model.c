@@ -93,6 +93,11 @@ float Model_RenderDistance(struct Entity* e) {
 	return dx * dx + dy * dy + dz * dz;
 }
 
+/* Model being batched, and entities queued up to be drawn with it (see Model_BeginBatch) */
+static struct Model* batchModel;
+static struct Entity* batchEntities[ENTITIES_MAX_COUNT];
+static int batchCount;
+
 void Model_Render(struct Model* model, struct Entity* e) {
 	struct Matrix m;
 	Vec3 pos = e->Position;
@@ -100,6 +105,11 @@ void Model_Render(struct Model* model, struct Entity* e) {
 	/* Original classic offsets models slightly into ground */
 	if (Game_ClassicMode) pos.Y -= 1.5f / 16.0f;
 
+	if (model == batchModel && batchCount < ENTITIES_MAX_COUNT) {
+		model->GetTransform(e, pos, &e->Transform);
+		batchEntities[batchCount++] = e; return;
+	}
+
 	Model_SetupState(model, e);
 	Gfx_SetVertexFormat(VERTEX_FORMAT_TEXTURED);
 
@@ -143,7 +153,8 @@ void Model_SetupState(struct Model* model, struct Entity* e) {
 	Models.Active  = model;
 }
 
-void Model_ApplyTexture(struct Entity* e) {
+/* Calculates skin type and UV scale for the given entity's skin texture, without binding it */
+static GfxResourceID Model_CalcTexture(struct Entity* e) {
 	struct Model* model = Models.Active;
 	struct ModelTex* data;
 	GfxResourceID tex;
@@ -158,11 +169,14 @@ void Model_ApplyTexture(struct Entity* e) {
 		Models.skinType = data->skinType;
 	}
 
-	Gfx_BindTexture(tex);
 	_64x64 = Models.skinType != SKIN_64x32;
-
 	Models.uScale = e->uScale * 0.015625f;
 	Models.vScale = e->vScale * (_64x64 ? 0.015625f : 0.03125f);
+	return tex;
+}
+
+void Model_ApplyTexture(struct Entity* e) {
+	Gfx_BindTexture(Model_CalcTexture(e));
 }
 
 
@@ -515,7 +529,7 @@ static void Models_TextureChanged(void* obj, struct Stream* stream, const cc_str
 	for (tex = textures_head; tex; tex = tex->next) {
 		if (!String_CaselessEqualsConst(name, tex->name)) continue;
 
-		Game_UpdateTexture(&tex->texID, stream, name, &tex->skinType);
+		Game_UpdateTexture(&tex->texID, stream, NULL, name, &tex->skinType);
 		return;
 	}
 }
@@ -912,18 +926,9 @@ struct ModelSet {
 #define HUMAN_BASE_VERTICES  (6 * MODEL_BOX_VERTICES)
 #define HUMAN_HAT32_VERTICES (1 * MODEL_BOX_VERTICES)
 #define HUMAN_HAT64_VERTICES (6 * MODEL_BOX_VERTICES)
-#define HUMAN_MAX_VERTICES   HUMAN_BASE_VERTICES + HUMAN_HAT64_VERTICES
-
-static void HumanModel_DrawCore(struct Entity* e, struct ModelSet* model, cc_bool opaqueBody) {
-	struct ModelLimbs* set;
-	int type, num;
-	Model_ApplyTexture(e);
-
-	type = Models.skinType;
-	set  = &model->limbs[type & 0x3];
-	num  = HUMAN_BASE_VERTICES + (type == SKIN_64x32 ? HUMAN_HAT32_VERTICES : HUMAN_HAT64_VERTICES);
-	Model_LockVB(e, num);
+#define HUMAN_MAX_VERTICES   (HUMAN_BASE_VERTICES + HUMAN_HAT64_VERTICES)
 
+static void HumanModel_DrawBody(struct Entity* e, struct ModelSet* model, struct ModelLimbs* set) {
 	Model_DrawRotate(-e->Pitch * MATH_DEG2RAD, 0, 0, &model->head, true);
 	Model_DrawPart(&model->torso);
 	Model_DrawRotate(e->Anim.LeftLegX,  0, e->Anim.LeftLegZ,  &set->leftLeg,  false);
@@ -933,7 +938,9 @@ static void HumanModel_DrawCore(struct Entity* e, struct ModelSet* model, cc_boo
 	Model_DrawRotate(e->Anim.LeftArmX,  0, e->Anim.LeftArmZ,  &set->leftArm,  false);
 	Model_DrawRotate(e->Anim.RightArmX, 0, e->Anim.RightArmZ, &set->rightArm, false);
 	Models.Rotation = ROTATE_ORDER_ZYX;
+}
 
+static void HumanModel_DrawLayers(struct Entity* e, struct ModelSet* model, struct ModelLimbs* set, int type) {
 	if (type != SKIN_64x32) {
 		Model_DrawPart(&model->torsoLayer);
 		Model_DrawRotate(e->Anim.LeftLegX,  0, e->Anim.LeftLegZ,  &set->leftLegLayer,  false);
@@ -945,6 +952,20 @@ static void HumanModel_DrawCore(struct Entity* e, struct ModelSet* model, cc_boo
 		Models.Rotation = ROTATE_ORDER_ZYX;
 	}
 	Model_DrawRotate(-e->Pitch * MATH_DEG2RAD, 0, 0, &model->hat, true);
+}
+
+static void HumanModel_DrawCore(struct Entity* e, struct ModelSet* model, cc_bool opaqueBody) {
+	struct ModelLimbs* set;
+	int type, num;
+	Model_ApplyTexture(e);
+
+	type = Models.skinType;
+	set  = &model->limbs[type & 0x3];
+	num  = HUMAN_BASE_VERTICES + (type == SKIN_64x32 ? HUMAN_HAT32_VERTICES : HUMAN_HAT64_VERTICES);
+	Model_LockVB(e, num);
+
+	HumanModel_DrawBody(e, model, set);
+	HumanModel_DrawLayers(e, model, set, type);
 
 	Model_UnlockVB();
 	if (opaqueBody) {
@@ -1154,6 +1175,121 @@ static void HumanoidModel_Register(void) {
 }
 
 
+/*########################################################################################################################*
+*-----------------------------------------------------Batched humanoids---------------------------------------------------*
+*#########################################################################################################################*/
+/* Maximum number of humanoids drawn with one upload of the batch vertex buffer */
+#define HUMAN_BATCH_SIZE 16
+static GfxResourceID batchVb;
+
+void Model_BeginBatch(void) {
+#ifndef CC_BUILD_LOWMEM
+	/* Plugins may replace how humanoids are drawn, so only batch the built-in drawing */
+	if (human_model.Draw == HumanModel_Draw) batchModel = &human_model;
+#endif
+}
+
+static GfxResourceID HumanBatch_GetTexture(struct Entity* e) {
+	return e->TextureId ? e->TextureId : human_tex.texID;
+}
+
+/* Models are built in model space, so transform vertices into world space on the CPU instead */
+/* NOTE: Reads from src and only writes to dst, since dst is usually write-combined GPU memory */
+static void HumanBatch_Transform(struct VertexTextured* dst, const struct VertexTextured* src,
+								int count, const struct Matrix* m) {
+	float x, y, z;
+	int i;
+
+	for (i = 0; i < count; i++, src++, dst++) {
+		x = src->X; y = src->Y; z = src->Z;
+		dst->X = x * m->row1.X + y * m->row2.X + z * m->row3.X + m->row4.X;
+		dst->Y = x * m->row1.Y + y * m->row2.Y + z * m->row3.Y + m->row4.Y;
+		dst->Z = x * m->row1.Z + y * m->row2.Z + z * m->row3.Z + m->row4.Z;
+		dst->Col = src->Col; dst->U = src->U; dst->V = src->V;
+	}
+}
+
+/* Draws humanoids that all use the same skin texture with just two draw calls */
+static void HumanBatch_Draw(struct Entity** entities, int count, GfxResourceID tex) {
+	/* Each humanoid is built in the CPU side vertices array, then copied into the batch */
+	struct VertexTextured* scratch = Models.Vertices;
+	struct VertexTextured* body;
+	struct VertexTextured* layers;
+	struct ModelLimbs* set;
+	struct Entity* e;
+	int i, type, bodyCount, layerCount, layersCount = 0;
+
+	if (!batchVb) {
+		batchVb = Gfx_CreateDynamicVb(VERTEX_FORMAT_TEXTURED, HUMAN_BATCH_SIZE * HUMAN_MAX_VERTICES);
+	}
+	/* All bodies come first, followed by all hat/clothing layers */
+	bodyCount = count * HUMAN_BASE_VERTICES;
+	body      = (struct VertexTextured*)Gfx_LockDynamicVb(batchVb, VERTEX_FORMAT_TEXTURED,
+													count * HUMAN_MAX_VERTICES);
+	layers    = body + bodyCount;
+
+	for (i = 0; i < count; i++) 
+	{
+		e = entities[i];
+		Model_SetupState(&human_model, e);
+		Model_CalcTexture(e);
+		type = Models.skinType;
+		set  = &human_set.limbs[type & 0x3];
+
+		HumanModel_DrawBody(e, &human_set, set);
+		HumanModel_DrawLayers(e, &human_set, set, type);
+		layerCount = human_model.index - HUMAN_BASE_VERTICES;
+		human_model.index = 0;
+
+		HumanBatch_Transform(body,   scratch, HUMAN_BASE_VERTICES, &e->Transform);
+		HumanBatch_Transform(layers, scratch + HUMAN_BASE_VERTICES, layerCount, &e->Transform);
+		body   += HUMAN_BASE_VERTICES;
+		layers += layerCount; layersCount += layerCount;
+	}
+	Gfx_UnlockDynamicVb(batchVb);
+	Gfx_BindTexture(tex);
+
+	/* human model draws the body opaque so players can't have invisible skins */
+	Gfx_SetAlphaTest(false);
+	Gfx_DrawVb_IndexedTris_Range(bodyCount, 0);
+	Gfx_SetAlphaTest(true);
+	Gfx_DrawVb_IndexedTris_Range(layersCount, bodyCount);
+}
+
+void Model_EndBatch(void) {
+	struct Entity* e;
+	GfxResourceID tex;
+	int i, j, beg, count;
+
+	batchModel = NULL;
+	if (!batchCount) return;
+
+	/* Sort so that entities using the same skin texture are next to each other */
+	for (i = 1; i < batchCount; i++) 
+	{
+		e   = batchEntities[i];
+		tex = HumanBatch_GetTexture(e);
+
+		for (j = i; j > 0 && HumanBatch_GetTexture(batchEntities[j - 1]) > tex; j--) {
+			batchEntities[j] = batchEntities[j - 1];
+		}
+		batchEntities[j] = e;
+	}
+
+	Gfx_SetVertexFormat(VERTEX_FORMAT_TEXTURED);
+	for (beg = 0; beg < batchCount; beg += count) 
+	{
+		tex = HumanBatch_GetTexture(batchEntities[beg]);
+
+		for (count = 1; count < HUMAN_BATCH_SIZE && beg + count < batchCount; count++) {
+			if (HumanBatch_GetTexture(batchEntities[beg + count]) != tex) break;
+		}
+		HumanBatch_Draw(&batchEntities[beg], count, tex);
+	}
+	batchCount = 0;
+}
+
+
 /*########################################################################################################################*
 *---------------------------------------------------------ChibiModel------------------------------------------------------*
 *#########################################################################################################################*/
@@ -2391,6 +2527,7 @@ static void RegisterDefaultModels(void) {
 static void OnContextLost(void* obj) {
 	struct ModelTex* tex;
 	Gfx_DeleteDynamicVb(&Models.Vb);
+	Gfx_DeleteDynamicVb(&batchVb);
 	if (Gfx.ManagedTextures) return;
 
 	for (tex = textures_head; tex; tex = tex->next) 
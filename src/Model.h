@@ -132,6 +132,11 @@ CC_API void Model_SetupState(struct Model* model, struct Entity* entity);
 /* Uses model's default texture if the entity doesn't have a custom skin. */
 CC_API void Model_ApplyTexture(struct Entity* entity);
 
+/* Starts queueing up humanoid models passed to Model_Render, instead of drawing them immediately. */
+void Model_BeginBatch(void);
+/* Draws all queued up humanoid models, with entities sharing a skin texture drawn together. */
+void Model_EndBatch(void);
+
 /* Flushes buffered vertices to the GPU. */
 CC_API void Model_UpdateVB(void);
 void Model_LockVB(struct Entity* entity, int verticesCount);
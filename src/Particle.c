@@ -122,6 +122,21 @@ static cc_bool PhysicsTick(struct Particle* p, float gravity, CanPassThroughFunc
 	return p->lifetime < 0.0f;
 }
 
+/* Removes the given number of oldest particles from the start of a list of particles */
+static void Particles_RemoveOldest(void* particles, int* count, int elemSize, int amount) {
+	cc_uint8* dst = (cc_uint8*)particles;
+	cc_uint8* src;
+	int i, size;
+	if (amount <= 0) return;
+	if (amount > *count) amount = *count;
+
+	*count -= amount;
+	src  = dst + amount * elemSize;
+	size = *count * elemSize;
+	/* Regions overlap, but copying forwards is safe since src is after dst */
+	for (i = 0; i < size; i++) dst[i] = src[i];
+}
+
 
 /*########################################################################################################################*
 *-------------------------------------------------------Rain particle-----------------------------------------------------*
@@ -154,37 +169,23 @@ static void RainParticle_Render(struct Particle* p, float t, struct VertexTextur
 	Particle_DoRender(&size, &pos, &rain_rec, col, vertices);
 }
 
-static void Rain_Render(float t) {
-	struct VertexTextured* data;
+static void Rain_Render(float t, struct VertexTextured* data) {
 	int i;
-	if (!rain_count) return;
-	
-	data = (struct VertexTextured*)Gfx_LockDynamicVb(particles_VB, 
-										VERTEX_FORMAT_TEXTURED, rain_count * 4);
 	for (i = 0; i < rain_count; i++) {
 		RainParticle_Render(&rain_Particles[i], t, data);
 		data += 4;
 	}
-
-	Gfx_BindTexture(particles_TexId);
-	Gfx_UnlockDynamicVb(particles_VB);
-	Gfx_DrawVb_IndexedTris(rain_count * 4);
-}
-
-static void Rain_RemoveAt(int i) {
-	for (; i < rain_count - 1; i++) {
-		rain_Particles[i] = rain_Particles[i + 1];
-	}
-	rain_count--;
 }
 
 static void Rain_Tick(double delta) {
-	int i;
-	for (i = 0; i < rain_count; i++) {
-		if (RainParticle_Tick(&rain_Particles[i], delta)) {
-			Rain_RemoveAt(i); i--;
-		}
+	int i, j;
+	/* Compact surviving particles in place, preserving their order */
+	for (i = 0, j = 0; i < rain_count; i++) {
+		if (RainParticle_Tick(&rain_Particles[i], delta)) continue;
+		if (i != j) rain_Particles[j] = rain_Particles[i];
+		j++;
 	}
+	rain_count = j;
 }
 
 
@@ -246,27 +247,22 @@ static void Terrain_Update1DCounts(void) {
 	}
 }
 
-static void Terrain_Render(float t) {
-	struct VertexTextured* data;
-	struct VertexTextured* ptr;
-	int offset = 0;
+static void Terrain_Render(float t, struct VertexTextured* data) {
 	int i, index;
-	if (!terrain_count) return;
 
-	data = (struct VertexTextured*)Gfx_LockDynamicVb(particles_VB, 
-										VERTEX_FORMAT_TEXTURED, terrain_count * 4);
 	Terrain_Update1DCounts();
 	for (i = 0; i < terrain_count; i++) {
 		index = Atlas1D_Index(terrain_particles[i].texLoc);
-		ptr   = data + terrain_1DIndices[index];
-
-		TerrainParticle_Render(&terrain_particles[i], t, ptr);
+		TerrainParticle_Render(&terrain_particles[i], t, data + terrain_1DIndices[index]);
 		terrain_1DIndices[index] += 4;
 	}
+}
+
+static void Terrain_Draw(void) {
+	int i, partCount, offset = 0;
 
-	Gfx_UnlockDynamicVb(particles_VB);
 	for (i = 0; i < Atlas1D.Count; i++) {
-		int partCount = terrain_1DCount[i];
+		partCount = terrain_1DCount[i];
 		if (!partCount) continue;
 
 		Gfx_BindTexture(Atlas1D.TexIds[i]);
@@ -275,20 +271,14 @@ static void Terrain_Render(float t) {
 	}
 }
 
-static void Terrain_RemoveAt(int i) {
-	for (; i < terrain_count - 1; i++) {
-		terrain_particles[i] = terrain_particles[i + 1];
-	}
-	terrain_count--;
-}
-
 static void Terrain_Tick(double delta) {
-	int i;
-	for (i = 0; i < terrain_count; i++) {
-		if (TerrainParticle_Tick(&terrain_particles[i], delta)) {
-			Terrain_RemoveAt(i); i--;
-		}
+	int i, j;
+	for (i = 0, j = 0; i < terrain_count; i++) {
+		if (TerrainParticle_Tick(&terrain_particles[i], delta)) continue;
+		if (i != j) terrain_particles[j] = terrain_particles[i];
+		j++;
 	}
+	terrain_count = j;
 }
 
 /*########################################################################################################################*
@@ -355,37 +345,22 @@ static void CustomParticle_Render(struct CustomParticle* p, float t, struct Vert
 	Particle_DoRender(&size, &pos, &rec, col, vertices);
 }
 
-static void Custom_Render(float t) {
-	struct VertexTextured* data;
+static void Custom_Render(float t, struct VertexTextured* data) {
 	int i;
-	if (!custom_count) return;
-
-	data = (struct VertexTextured*)Gfx_LockDynamicVb(particles_VB, 
-										VERTEX_FORMAT_TEXTURED, custom_count * 4);
 	for (i = 0; i < custom_count; i++) {
 		CustomParticle_Render(&custom_particles[i], t, data);
 		data += 4;
 	}
-
-	Gfx_BindTexture(particles_TexId);
-	Gfx_UnlockDynamicVb(particles_VB);
-	Gfx_DrawVb_IndexedTris(custom_count * 4);
-}
-
-static void Custom_RemoveAt(int i) {
-	for (; i < custom_count - 1; i++) {
-		custom_particles[i] = custom_particles[i + 1];
-	}
-	custom_count--;
 }
 
 static void Custom_Tick(double delta) {
-	int i;
-	for (i = 0; i < custom_count; i++) {
-		if (CustomParticle_Tick(&custom_particles[i], delta)) {
-			Custom_RemoveAt(i); i--;
-		}
+	int i, j;
+	for (i = 0, j = 0; i < custom_count; i++) {
+		if (CustomParticle_Tick(&custom_particles[i], delta)) continue;
+		if (i != j) custom_particles[j] = custom_particles[i];
+		j++;
 	}
+	custom_count = j;
 }
 
 
@@ -393,19 +368,33 @@ static void Custom_Tick(double delta) {
 *--------------------------------------------------------Particles--------------------------------------------------------*
 *#########################################################################################################################*/
 void Particles_Render(float t) {
+	struct VertexTextured* data;
+	int count, terrainVerts, otherVerts;
 	if (!terrain_count && !rain_count && !custom_count) return;
 
 	if (Gfx.LostContext) return;
 	if (!particles_VB)
-		particles_VB = Gfx_CreateDynamicVb(VERTEX_FORMAT_TEXTURED, PARTICLES_MAX * 4);
+		particles_VB = Gfx_CreateDynamicVb(VERTEX_FORMAT_TEXTURED, PARTICLES_MAX * 3 * 4);
 
+	/* All particles are written into the dynamic VB at once, so it only needs to be uploaded once */
+	/* Terrain particles (sorted by 1D atlas) come first, then rain and custom particles */
+	count        = terrain_count + rain_count + custom_count;
+	terrainVerts = terrain_count * 4;
+	otherVerts   = (rain_count + custom_count) * 4;
 	Gfx_SetAlphaTest(true);
-
 	Gfx_SetVertexFormat(VERTEX_FORMAT_TEXTURED);
-	Terrain_Render(t);
-	Rain_Render(t);
-	Custom_Render(t);
+	data = (struct VertexTextured*)Gfx_LockDynamicVb(particles_VB, VERTEX_FORMAT_TEXTURED, count * 4);
+
+	Terrain_Render(t, data);
+	Rain_Render(t,    data + terrainVerts);
+	Custom_Render(t,  data + terrainVerts + rain_count * 4);
+	Gfx_UnlockDynamicVb(particles_VB);
 
+	if (terrainVerts) Terrain_Draw();
+	if (otherVerts) {
+		Gfx_BindTexture(particles_TexId);
+		Gfx_DrawVb_IndexedTris_Range(otherVerts, terrainVerts);
+	}
 	Gfx_SetAlphaTest(false);
 }
 
@@ -416,6 +405,22 @@ static void Particles_Tick(struct ScheduledTask* task) {
 	Custom_Tick(delta);
 }
 
+#define GRID_SIZE 4
+/* gridOffset gives the centre of the cell on a grid */
+#define CELL_CENTRE ((1.0f / GRID_SIZE) * 0.5f)
+
+/* Counts how many grid cells along an axis lie inside the given block bounds */
+static int Terrain_CountCells(float min, float max, float centre) {
+	float cell;
+	int i, count = 0;
+
+	for (i = 0; i < GRID_SIZE; i++) {
+		cell = centre + (float)i / GRID_SIZE;
+		if (cell >= min && cell <= max) count++;
+	}
+	return count;
+}
+
 void Particles_BreakBlockEffect(IVec3 coords, BlockID old, BlockID now) {
 	struct TerrainParticle* p;
 	TextureLoc loc;
@@ -432,7 +437,7 @@ void Particles_BreakBlockEffect(IVec3 coords, BlockID old, BlockID now) {
 	/* per-particle variables */
 	float cellX, cellY, cellZ;
 	Vec3 cell;
-	int x, y, z, type;
+	int x, y, z, type, count;
 
 	if (now != BLOCK_AIR || Blocks.Draw[old] == DRAW_GAS) return;
 	IVec3_ToVec3(&origin, &coords);
@@ -452,12 +457,16 @@ void Particles_BreakBlockEffect(IVec3 coords, BlockID old, BlockID now) {
 	if (minU < 12 && maxU > 12) maxUsedU = 12;
 	if (minV < 12 && maxV > 12) maxUsedV = 12;
 
-	#define GRID_SIZE 4
-	/* gridOffset gives the centre of the cell on a grid */
-	#define CELL_CENTRE ((1.0f / GRID_SIZE) * 0.5f)
-
 	maxU2 = baseRec.U1 + maxU * uScale;
 	maxV2 = baseRec.V1 + maxV * vScale;
+
+	/* Make room for all the new particles at once, rather than shifting the list for each particle */
+	count = Terrain_CountCells(minBB.X, maxBB.X, CELL_CENTRE) 
+		  * Terrain_CountCells(minBB.Y, maxBB.Y, CELL_CENTRE / 2)
+		  * Terrain_CountCells(minBB.Z, maxBB.Z, CELL_CENTRE);
+	Particles_RemoveOldest(terrain_particles, &terrain_count, sizeof(struct TerrainParticle),
+							terrain_count + count - PARTICLES_MAX);
+
 	for (x = 0; x < GRID_SIZE; x++) {
 		for (y = 0; y < GRID_SIZE; y++) {
 			for (z = 0; z < GRID_SIZE; z++) {
@@ -467,7 +476,6 @@ void Particles_BreakBlockEffect(IVec3 coords, BlockID old, BlockID now) {
 				if (cell.X < minBB.X || cell.X > maxBB.X || cell.Y < minBB.Y
 					|| cell.Y > maxBB.Y || cell.Z < minBB.Z || cell.Z > maxBB.Z) continue;
 
-				if (terrain_count == PARTICLES_MAX) Terrain_RemoveAt(0);
 				p = &terrain_particles[terrain_count++];
 
 				/* centre random offset around [-0.2, 0.2] */
@@ -501,8 +509,10 @@ void Particles_RainSnowEffect(float x, float y, float z) {
 	struct Particle* p;
 	int i, type;
 
+	Particles_RemoveOldest(rain_Particles, &rain_count, sizeof(struct Particle),
+							rain_count + 2 - PARTICLES_MAX);
+
 	for (i = 0; i < 2; i++) {
-		if (rain_count == PARTICLES_MAX) Rain_RemoveAt(0);
 		p = &rain_Particles[rain_count++];
 
 		p->velocity.X = Random_Float(&rnd) * 0.8f - 0.4f; /* [-0.4, 0.4] */
@@ -528,8 +538,10 @@ void Particles_CustomEffect(int effectID, float x, float y, float z, float origi
 	Vec3 offset, delta;
 	float d;
 
+	Particles_RemoveOldest(custom_particles, &custom_count, sizeof(struct CustomParticle),
+							custom_count + count - PARTICLES_MAX);
+
 	for (i = 0; i < count; i++) {
-		if (custom_count == PARTICLES_MAX) Custom_RemoveAt(0);
 		p = &custom_particles[custom_count++];
 		p->effectId = effectID;
 
@@ -573,8 +585,8 @@ void Particles_CustomEffect(int effectID, float x, float y, float z, float origi
 /*########################################################################################################################*
 *---------------------------------------------------Particles component---------------------------------------------------*
 *#########################################################################################################################*/
-static void ParticlesPngProcess(struct Stream* stream, const cc_string* name) {
-	Game_UpdateTexture(&particles_TexId, stream, name, NULL);
+static void ParticlesPngProcess(struct Stream* stream, const cc_string* name, struct Bitmap* decoded) {
+	Game_UpdateTexture(&particles_TexId, stream, decoded, name, NULL);
 }
 static struct TextureEntry particles_entry = { "particles.png", ParticlesPngProcess };
 
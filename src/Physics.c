@@ -7,6 +7,7 @@
 #include "Funcs.h"
 #include "Logger.h"
 #include "Entity.h"
+#include "Utils.h"
 
 
 /*########################################################################################################################*
@@ -128,7 +129,7 @@ cc_bool Intersection_RayIntersectsBox(Vec3 origin, Vec3 dir, Vec3 min, Vec3 max,
 *#########################################################################################################################*/
 #define SEARCHER_STATES_MIN 64
 static struct SearcherState searcherDefaultStates[SEARCHER_STATES_MIN];
-static cc_uint32 searcherCapacity = SEARCHER_STATES_MIN;
+static int searcherCapacity = SEARCHER_STATES_MIN;
 struct SearcherState* Searcher_States = searcherDefaultStates;
 
 static void Searcher_QuickSort(int left, int right) {
@@ -149,17 +150,33 @@ static void Searcher_QuickSort(int left, int right) {
 	}
 }
 
+/* Adds a candidate block to the end of the list */
+/* NOTE: The list only grows with the number of solid blocks found, not with the volume searched */
+static void Searcher_Add(int count, int x, int y, int z, BlockID block, float tSquared) {
+	struct SearcherState* state;
+
+	if (count == searcherCapacity) {
+		Utils_Resize((void**)&Searcher_States, &searcherCapacity,
+			sizeof(struct SearcherState), SEARCHER_STATES_MIN, SEARCHER_STATES_MIN);
+	}
+	state = &Searcher_States[count];
+
+	state->X = (x << 3) | (block  & 0x007);
+	state->Y = (y << 4) | ((block & 0x078) >> 3);
+	state->Z = (z << 3) | ((block & 0x380) >> 7);
+	state->tSquared = tSquared;
+}
+
 int Searcher_FindReachableBlocks(struct Entity* entity, struct AABB* entityBB, struct AABB* entityExtentBB) {
 	Vec3 vel = entity->Velocity;
 	IVec3 min, max;
-	cc_uint32 elements;
-	struct SearcherState* curState;
-	int count;
+	int count = 0;
 
 	BlockID block;
 	struct AABB blockBB;
 	float xx, yy, zz, tx, ty, tz;
 	int x, y, z;
+	cc_bool rowInside;
 
 	Entity_GetBounds(entity, entityBB);
 	/* Exact maximum extent the entity can reach, and the equivalent map coordinates. */
@@ -173,20 +190,21 @@ int Searcher_FindReachableBlocks(struct Entity* entity, struct AABB* entityBB, s
 
 	IVec3_Floor(&min, &entityExtentBB->Min);
 	IVec3_Floor(&max, &entityExtentBB->Max);
-	elements = (max.X - min.X + 1) * (max.Y - min.Y + 1) * (max.Z - min.Z + 1);
 
-	if (elements > searcherCapacity) {
-		Searcher_Free();
-		searcherCapacity = elements;
-		Searcher_States  = (struct SearcherState*)Mem_Alloc(elements, sizeof(struct SearcherState), "collision search states");
+	/* Above the map is only air when inside the map horizontally (outside it is bedrock at any height) */
+	if (min.X >= 0 && max.X < World.Width && min.Z >= 0 && max.Z < World.Length) {
+		if (max.Y >= World.Height) max.Y = World.Height - 1;
+		if (min.Y > max.Y) return 0;
 	}
-	curState = Searcher_States;
 
 	/* Order loops so that we minimise cache misses */
 	for (y = min.Y; y <= max.Y; y++) {
 		for (z = min.Z; z <= max.Z; z++) {
+			/* Avoid per block bounds checks when the whole row lies inside the map */
+			rowInside = y >= 0 && y < World.Height && (unsigned)z < (unsigned)World.Length && min.X >= 0 && max.X < World.Width;
+
 			for (x = min.X; x <= max.X; x++) {
-				block = World_GetPhysicsBlock(x, y, z);
+				block = rowInside ? World_GetBlock(x, y, z) : World_GetPhysicsBlock(x, y, z);
 				if (Blocks.Collide[block] != COLLIDE_SOLID) continue;
 
 				xx = (float)x; yy = (float)y; zz = (float)z;
@@ -199,16 +217,12 @@ int Searcher_FindReachableBlocks(struct Entity* entity, struct AABB* entityBB, s
 				Searcher_CalcTime(&vel, entityBB, &blockBB, &tx, &ty, &tz);
 				if (tx > 1.0f || ty > 1.0f || tz > 1.0f) continue;
 
-				curState->X = (x << 3) | (block  & 0x007);
-				curState->Y = (y << 4) | ((block & 0x078) >> 3);
-				curState->Z = (z << 3) | ((block & 0x380) >> 7);
-				curState->tSquared = tx * tx + ty * ty + tz * tz;
-				curState++;
+				Searcher_Add(count, x, y, z, block, tx * tx + ty * ty + tz * tz);
+				count++;
 			}
 		}
 	}
 
-	count = (int)(curState - Searcher_States);
 	if (count) Searcher_QuickSort(0, count - 1);
 	return count;
 }
@@ -8,27 +8,28 @@
 #include "Block.h"
 #include "Logger.h"
 #include "Camera.h"
+#include "Platform.h"
+#include "Utils.h"
 
-static float pickedPos_dist;
-static void TestAxis(struct RayTracer* t, float dAxis, Face fAxis) {
+static void TestAxis(struct RayTracer* t, float dAxis, Face fAxis, float* closestDist) {
 	dAxis = Math_AbsF(dAxis);
-	if (dAxis >= pickedPos_dist) return;
+	if (dAxis >= *closestDist) return;
 
-	pickedPos_dist = dAxis;
-	t->Closest     = fAxis;
+	*closestDist = dAxis;
+	t->Closest   = fAxis;
 }
 
 static void SetAsValid(struct RayTracer* t) {
+	float dist = MATH_LARGENUM;
 	t->TranslatedPos = t->pos;
 	t->Valid         = true;
 
-	pickedPos_dist = MATH_LARGENUM;
-	TestAxis(t, t->Intersect.X - t->Min.X, FACE_XMIN);
-	TestAxis(t, t->Intersect.X - t->Max.X, FACE_XMAX);
-	TestAxis(t, t->Intersect.Y - t->Min.Y, FACE_YMIN);
-	TestAxis(t, t->Intersect.Y - t->Max.Y, FACE_YMAX);
-	TestAxis(t, t->Intersect.Z - t->Min.Z, FACE_ZMIN);
-	TestAxis(t, t->Intersect.Z - t->Max.Z, FACE_ZMAX);
+	TestAxis(t, t->Intersect.X - t->Min.X, FACE_XMIN, &dist);
+	TestAxis(t, t->Intersect.X - t->Max.X, FACE_XMAX, &dist);
+	TestAxis(t, t->Intersect.Y - t->Min.Y, FACE_YMIN, &dist);
+	TestAxis(t, t->Intersect.Y - t->Max.Y, FACE_YMAX, &dist);
+	TestAxis(t, t->Intersect.Z - t->Min.Z, FACE_ZMIN, &dist);
+	TestAxis(t, t->Intersect.Z - t->Max.Z, FACE_ZMAX, &dist);
 
 	switch (t->Closest) {
 	case FACE_XMIN: t->TranslatedPos.X--; break;
@@ -102,6 +103,60 @@ void RayTracer_Step(struct RayTracer* t) {
 	}
 }
 
+/* Number of cell boundaries crossed along an axis before the ray reaches time tExit (capped to maxCount) */
+static int RayTracer_Crossings(float tMax, float tDelta, float tExit, int maxCount) {
+	int count;
+	if (tMax >= tExit) return 0;
+
+	count = (int)((tExit - tMax) / tDelta) + 1;
+	return min(count, maxCount);
+}
+
+/* Moves to the first grid cell on the ray that is outside the given box of cells */
+/* NOTE: Current grid cell position must be inside the box. */
+static void RayTracer_ExitBox(struct RayTracer* t, const IVec3* boxMin, const IVec3* boxMax) {
+	IVec3 left, moved;
+	Vec3 tLeave;
+	float tExit;
+
+	/* Number of cells left in the box along each axis, after the current cell */
+	left.X = t->step.X > 0 ? boxMax->X - t->pos.X : boxMin->X - t->pos.X;
+	left.Y = t->step.Y > 0 ? boxMax->Y - t->pos.Y : boxMin->Y - t->pos.Y;
+	left.Z = t->step.Z > 0 ? boxMax->Z - t->pos.Z : boxMin->Z - t->pos.Z;
+	left.X = Math_AbsI(left.X); left.Y = Math_AbsI(left.Y); left.Z = Math_AbsI(left.Z);
+
+	/* When the ray crosses the box's boundary plane along each axis */
+	tLeave.X = t->step.X ? t->tMax.X + left.X * t->tDelta.X : MATH_LARGENUM;
+	tLeave.Y = t->step.Y ? t->tMax.Y + left.Y * t->tDelta.Y : MATH_LARGENUM;
+	tLeave.Z = t->step.Z ? t->tMax.Z + left.Z * t->tDelta.Z : MATH_LARGENUM;
+
+	/* Same as RayTracer_Step, the nearest boundary plane is the one the ray leaves the box through */
+	if (tLeave.X < tLeave.Y && tLeave.X < tLeave.Z) {
+		tExit   = tLeave.X;
+		moved.X = left.X + 1;
+		moved.Y = RayTracer_Crossings(t->tMax.Y, t->tDelta.Y, tExit, left.Y);
+		moved.Z = RayTracer_Crossings(t->tMax.Z, t->tDelta.Z, tExit, left.Z);
+	} else if (tLeave.Y < tLeave.Z) {
+		tExit   = tLeave.Y;
+		moved.X = RayTracer_Crossings(t->tMax.X, t->tDelta.X, tExit, left.X);
+		moved.Y = left.Y + 1;
+		moved.Z = RayTracer_Crossings(t->tMax.Z, t->tDelta.Z, tExit, left.Z);
+	} else {
+		tExit   = tLeave.Z;
+		moved.X = RayTracer_Crossings(t->tMax.X, t->tDelta.X, tExit, left.X);
+		moved.Y = RayTracer_Crossings(t->tMax.Y, t->tDelta.Y, tExit, left.Y);
+		moved.Z = left.Z + 1;
+	}
+
+	if (!t->step.X) moved.X = 0;
+	if (!t->step.Y) moved.Y = 0;
+	if (!t->step.Z) moved.Z = 0;
+
+	t->pos.X  += t->step.X * moved.X; t->tMax.X += moved.X * t->tDelta.X;
+	t->pos.Y  += t->step.Y * moved.Y; t->tMax.Y += moved.Y * t->tDelta.Y;
+	t->pos.Z  += t->step.Z * moved.Z; t->tMax.Z += moved.Z * t->tDelta.Z;
+}
+
 #define BORDER BLOCK_BEDROCK
 typedef cc_bool (*IntersectTest)(struct RayTracer* t);
 
@@ -151,9 +206,112 @@ static BlockID Picking_GetOutside(int x, int y, int z, IVec3 origin) {
 	return BLOCK_AIR;
 }
 
-static cc_bool RayTrace(struct RayTracer* t, const Vec3* origin, const Vec3* dir, float reach, IntersectTest intersect) {
-	IVec3 pOrigin;
-	cc_bool insideMap;
+/*########################################################################################################################*
+*--------------------------------------------------------Occupancy--------------------------------------------------------*
+*#########################################################################################################################*/
+/* Each 16x16x16 chunk of the world has a 64 bit mask of which of its 4x4x4 sub-chunks contain any non-air blocks */
+/* This lets the ray tracer jump over empty sub-chunks (or whole empty chunks) in a single step */
+/* Each sub-chunk is only checked when a ray first enters it, and checked again after a block in it is removed */
+/* NOTE: Rays cast on other threads only read these masks, as updating them from several threads would race */
+static cc_uint64* occupancy_solid; /* Sub-chunks that contain any non-air blocks */
+static cc_uint64* occupancy_known; /* Sub-chunks whose bit in occupancy_solid is up to date */
+static int occupancy_count;
+#define OCCUPANCY_SUB_SIZE 4
+#define Occupancy_Bit(x, y, z) ((cc_uint64)1 << ((((y) & 0xC) << 2) | ((z) & 0xC) | (((x) & 0xC) >> 2)))
+
+static void Occupancy_Free(void) {
+	Mem_Free(occupancy_solid);
+	Mem_Free(occupancy_known);
+	occupancy_solid = NULL;
+	occupancy_known = NULL;
+	occupancy_count = 0;
+}
+
+static cc_bool Occupancy_Init(void) {
+	if (occupancy_count == World.ChunksCount) return true;
+	Occupancy_Free();
+
+	occupancy_solid = (cc_uint64*)Mem_TryAllocCleared(World.ChunksCount, sizeof(cc_uint64));
+	occupancy_known = (cc_uint64*)Mem_TryAllocCleared(World.ChunksCount, sizeof(cc_uint64));
+	if (!occupancy_solid || !occupancy_known) { Occupancy_Free(); return false; }
+
+	occupancy_count = World.ChunksCount;
+	return true;
+}
+
+static cc_bool Occupancy_CalcSolid(int x1, int y1, int z1) {
+	int x2 = min(x1 + OCCUPANCY_SUB_SIZE, World.Width);
+	int y2 = min(y1 + OCCUPANCY_SUB_SIZE, World.Height);
+	int z2 = min(z1 + OCCUPANCY_SUB_SIZE, World.Length);
+	int x, y, z;
+
+	for (y = y1; y < y2; y++) {
+		for (z = z1; z < z2; z++) {
+			for (x = x1; x < x2; x++) {
+				if (World_GetBlock(x, y, z) != BLOCK_AIR) return true;
+			}
+		}
+	}
+	return false;
+}
+
+/* Calculates the box of cells around the given coordinates that only contains air */
+/* Returns false if the 4x4x4 sub-chunk containing the given coordinates has any non-air blocks */
+/* NOTE: Does NOT check that the coordinates are inside the map. */
+static cc_bool Occupancy_GetEmptyBox(int x, int y, int z, IVec3* boxMin, IVec3* boxMax, cc_bool update) {
+	int cx = x >> CHUNK_SHIFT, cy = y >> CHUNK_SHIFT, cz = z >> CHUNK_SHIFT;
+	int i  = World_ChunkPack(cx, cy, cz);
+	cc_uint64 bit = Occupancy_Bit(x, y, z);
+	int size;
+
+	if (!(occupancy_known[i] & bit)) {
+		/* Sub-chunks not checked yet are just stepped through normally when the masks can't be updated */
+		if (!update) return false;
+
+		if (Occupancy_CalcSolid(x & ~0x3, y & ~0x3, z & ~0x3)) {
+			occupancy_solid[i] |= bit;
+		} else {
+			occupancy_solid[i] &= ~bit;
+		}
+		occupancy_known[i] |= bit;
+	}
+	if (occupancy_solid[i] & bit) return false;
+
+	/* Whole chunk can be jumped over once all of its sub-chunks are known to be empty */
+	if (!occupancy_solid[i] && occupancy_known[i] == ~(cc_uint64)0) {
+		size = CHUNK_SIZE;
+	} else {
+		size = OCCUPANCY_SUB_SIZE;
+	}
+
+	boxMin->X = x & ~(size - 1); boxMax->X = min(boxMin->X + size - 1, World.MaxX);
+	boxMin->Y = y & ~(size - 1); boxMax->Y = min(boxMin->Y + size - 1, World.MaxY);
+	boxMin->Z = z & ~(size - 1); boxMax->Z = min(boxMin->Z + size - 1, World.MaxZ);
+	return true;
+}
+
+void Picking_OnBlockChanged(int x, int y, int z, BlockID block) {
+	int i;
+	if (!occupancy_count) return;
+	i = World_ChunkPack(x >> CHUNK_SHIFT, y >> CHUNK_SHIFT, z >> CHUNK_SHIFT);
+
+	if (block != BLOCK_AIR) {
+		occupancy_solid[i] |= Occupancy_Bit(x, y, z);
+	} else {
+		/* Other blocks may still be in the same sub-chunk, so check again later */
+		occupancy_known[i] &= ~Occupancy_Bit(x, y, z);
+	}
+}
+
+
+/*########################################################################################################################*
+*--------------------------------------------------------Ray tracing------------------------------------------------------*
+*#########################################################################################################################*/
+/* NOTE: updateOccupancy must be false when the ray is not being cast on the main thread */
+static cc_bool RayTrace(struct RayTracer* t, const Vec3* origin, const Vec3* dir, float reach,
+						IntersectTest intersect, cc_bool updateOccupancy) {
+	IVec3 pOrigin, boxMin, boxMax;
+	cc_bool insideMap, skipEmpty;
 	float reachSq;
 	Vec3 v;
 
@@ -173,11 +331,23 @@ static cc_bool RayTrace(struct RayTracer* t, const Vec3* origin, const Vec3* dir
 	/*  pick blocks on the INSIDE of the map borders instead of OUTSIDE them */
 	insideMap = World_ContainsXZ(pOrigin.X, pOrigin.Z) && pOrigin.Y >= 0;
 	reachSq   = reach * reach;
+
+	/* Outside the map, the map borders may be picked even where the map itself contains air */
+	/* Skipping also relies on air being impossible to pick or clip against */
+	skipEmpty = insideMap && Blocks.Draw[BLOCK_AIR] == DRAW_GAS && World.Blocks
+				&& (updateOccupancy ? Occupancy_Init() : occupancy_count == World.ChunksCount);
 		
 	for (i = 0; i < 25000; i++) {
 		x   = t->pos.X; y   = t->pos.Y; z   = t->pos.Z;
 		v.X = (float)x; v.Y = (float)y; v.Z = (float)z;
 
+		/* Nothing can be picked in empty space, so jump straight to where the ray leaves it */
+		/* (the next cell reached is checked against the reach distance as normal) */
+		if (skipEmpty && World_Contains(x, y, z) && Occupancy_GetEmptyBox(x, y, z, &boxMin, &boxMax, updateOccupancy)) {
+			RayTracer_ExitBox(t, &boxMin, &boxMax);
+			continue;
+		}
+
 		t->block = insideMap ? Picking_GetInside(x, y, z) : Picking_GetOutside(x, y, z, pOrigin);
 		Vec3_Add(&t->Min, &v, &Blocks.RenderMinBB[t->block]);
 		Vec3_Add(&t->Max, &v, &Blocks.RenderMaxBB[t->block]);
@@ -196,12 +366,14 @@ static cc_bool RayTrace(struct RayTracer* t, const Vec3* origin, const Vec3* dir
 	return false;
 }
 
-static cc_bool ClipBlock(struct RayTracer* t) {
+/* Maximum distance from the ray's origin a block can be picked at */
+/* NOTE: Only changed on the main thread, before any rays are cast on other threads */
+static float clipReach;
+static cc_bool IntersectBlock(struct RayTracer* t) {
 	Vec3 scaledDir;
-	float lenSq, reach;
+	float lenSq;
 	float t0, t1;
 
-	if (!Game_CanPick(t->block)) return false;
 	/* This cell falls on the path of the ray. Now perform an additional AABB test,
 	since some blocks do not occupy a whole cell. */
 	if (!Intersection_RayIntersectsBox(t->origin, t->dir, t->Min, t->Max, &t0, &t1)) return false;
@@ -211,9 +383,7 @@ static cc_bool ClipBlock(struct RayTracer* t) {
 
 	/* Only pick the block if the block is precisely within reach distance. */
 	lenSq = Vec3_LengthSquared(&scaledDir);
-	reach = LocalPlayer_Instance.ReachDistance;
-
-	if (lenSq <= reach * reach) {
+	if (lenSq <= clipReach * clipReach) {
 		SetAsValid(t);
 	} else {
 		RayTracer_SetInvalid(t);
@@ -221,6 +391,15 @@ static cc_bool ClipBlock(struct RayTracer* t) {
 	return true;
 }
 
+static cc_bool ClipBlock(struct RayTracer* t) {
+	return Game_CanPick(t->block) && IntersectBlock(t);
+}
+
+/* Unlike Game_CanPick, does not depend on the held block (i.e. liquids always stop the ray) */
+static cc_bool CastBlock(struct RayTracer* t) {
+	return Blocks.Draw[t->block] != DRAW_GAS && IntersectBlock(t);
+}
+
 static const Vec3 picking_adjust = { 0.1f, 0.1f, 0.1f };
 static cc_bool ClipCamera(struct RayTracer* t) {
 	Vec3 intersect;
@@ -241,17 +420,81 @@ static cc_bool ClipCamera(struct RayTracer* t) {
 }
 
 void Picking_CalcPickedBlock(const Vec3* origin, const Vec3* dir, float reach, struct RayTracer* t) {
-	if (!RayTrace(t, origin, dir, reach, ClipBlock)) {
+	clipReach = LocalPlayer_Instance.ReachDistance;
+	if (!RayTrace(t, origin, dir, reach, ClipBlock, true)) {
 		RayTracer_SetInvalid(t);
 	}
 }
 
+/* Batches with fewer rays than this are cast on the calling thread */
+#define PICKING_RAYS_PER_JOB 64
+struct CastRaysJob { const Vec3* origins; const Vec3* dirs; int count; float reach; struct RayHit* hits; };
+
+static void CastRays(struct CastRaysJob* job, int beg, int end, cc_bool updateOccupancy) {
+	struct RayTracer t;
+	Vec3 delta;
+	int i;
+
+	for (i = beg; i < end; i++) 
+	{
+		if (!RayTrace(&t, &job->origins[i], &job->dirs[i], job->reach, CastBlock, updateOccupancy)) {
+			RayTracer_SetInvalid(&t);
+		}
+
+		job->hits[i].pos   = t.pos;
+		job->hits[i].block = t.block;
+		job->hits[i].face  = t.Closest;
+
+		if (t.Valid) {
+			Vec3_Sub(&delta, &t.Intersect, &job->origins[i]);
+			job->hits[i].distance = Math_SqrtF(Vec3_LengthSquared(&delta));
+		} else {
+			job->hits[i].distance = MATH_POS_INF;
+		}
+	}
+}
+
+static void CastRays_Job(void* obj, int index) {
+	struct CastRaysJob* job = (struct CastRaysJob*)obj;
+	int beg = index * PICKING_RAYS_PER_JOB;
+	CastRays(job, beg, min(beg + PICKING_RAYS_PER_JOB, job->count), false);
+}
+
+void Picking_CastRays(const Vec3* origins, const Vec3* dirs, int count, float reach, struct RayHit* hits) {
+	struct CastRaysJob job;
+	job.origins = origins; job.dirs = dirs; job.count = count;
+	job.reach   = reach;   job.hits = hits;
+	clipReach   = reach;
+
+	if (count < PICKING_RAYS_PER_JOB) {
+		CastRays(&job, 0, count, true);
+	} else {
+		/* Occupancy masks must be allocated up front, as rays on other threads never allocate them */
+		if (World.Blocks) Occupancy_Init();
+		Utils_ParallelFor(CastRays_Job, &job, (count + PICKING_RAYS_PER_JOB - 1) / PICKING_RAYS_PER_JOB);
+	}
+}
+
 void Picking_ClipCameraPos(const Vec3* origin, const Vec3* dir, float reach, struct RayTracer* t) {
 	cc_bool noClip = (!Camera.Clipping || LocalPlayer_Instance.Hacks.Noclip)
 						&& LocalPlayer_Instance.Hacks.CanNoclip;
-	if (noClip || !World.Loaded || !RayTrace(t, origin, dir, reach, ClipCamera)) {
+	if (noClip || !World.Loaded || !RayTrace(t, origin, dir, reach, ClipCamera, true)) {
 		RayTracer_SetInvalid(t);
 		Vec3_Mul1(&t->Intersect, dir, reach);           /* intersect = dir * reach */
 		Vec3_Add(&t->Intersect, origin, &t->Intersect); /* intersect = origin + dir * reach */
 	}
 }
+
+
+/*########################################################################################################################*
+*---------------------------------------------------Picking component-----------------------------------------------------*
+*#########################################################################################################################*/
+static void OnNewMap(void) { Occupancy_Free(); }
+
+struct IGameComponent Picking_Component = {
+	NULL,     /* Init  */
+	OnNewMap, /* Free  */
+	OnNewMap, /* Reset */
+	OnNewMap, /* OnNewMap */
+	OnNewMap  /* OnNewMapLoaded */
+};
@@ -16,6 +16,9 @@ John Amanatides, Andrew Woo
 http://www.cse.yorku.ca/~amana/research/grid.pdf
 http://www.devmaster.net/articles/raytracing_series/A%20faster%20voxel%20traversal%20algorithm%20for%20ray%20tracing.pdf
 */
+struct IGameComponent;
+extern struct IGameComponent Picking_Component;
+
 struct RayTracer {
 	IVec3 pos;    /* Coordinates of block within world */
 	Vec3 origin, dir;
@@ -42,4 +45,18 @@ void RayTracer_Step(struct RayTracer* t);
    or not being able to find a suitable candiate within the given reach distance.*/
 void Picking_CalcPickedBlock(const Vec3* origin, const Vec3* dir, float reach, struct RayTracer* t);
 void Picking_ClipCameraPos(const Vec3* origin, const Vec3* dir, float reach, struct RayTracer* t);
+
+/* Result of casting a single ray with Picking_CastRays */
+struct RayHit {
+	IVec3 pos;      /* Coordinates of the block that was hit, or (-1, -1, -1) if nothing was hit */
+	BlockID block;  /* The block that was hit, or BLOCK_AIR if nothing was hit */
+	Face face;      /* Face of the block that was hit, or FACE_COUNT if nothing was hit */
+	float distance; /* Distance from the origin to where the ray hit, or infinity if nothing was hit */
+};
+/* Casts each ray in turn until it hits a block that is not invisible within the given reach distance.
+   Unlike Picking_CalcPickedBlock, liquids always stop the ray regardless of the held block.
+   Large batches are split across several threads. NOTE: Must only be called from the main thread. */
+CC_API void Picking_CastRays(const Vec3* origins, const Vec3* dirs, int count, float reach, struct RayHit* hits);
+/* Updates the coarse occupancy data used to skip over empty space when ray tracing. */
+void Picking_OnBlockChanged(int x, int y, int z, BlockID block);
 #endif
@@ -163,6 +163,11 @@ cc_result File_Create(cc_file* file, const cc_string* path);
 cc_result File_Open(cc_file* file, const cc_string* path);
 /* Attempts to open an existing or create a new file for reading and writing. */
 cc_result File_OpenOrCreate(cc_file* file, const cc_string* path);
+/* Attempts to rename a file, replacing the destination file if it already exists. */
+/* NOTE: Returns ERR_NOT_SUPPORTED on platforms where this cannot be done. */
+cc_result File_Rename(const cc_string* src, const cc_string* dst);
+/* Whether File_Rename is supported by the platform */
+extern cc_bool File_RenameSupported;
 /* Attempts to read data from the file. */
 cc_result File_Read(cc_file file, void* data, cc_uint32 count, cc_uint32* bytesRead);
 /* Attempts to write data to the file. */
@@ -176,6 +176,13 @@ cc_result File_Create(cc_file* file, const cc_string* path) {
 cc_result File_OpenOrCreate(cc_file* file, const cc_string* path) {
 	return File_Do(file, path, O_RDWR | O_CREAT);
 }
+cc_bool File_RenameSupported = true;
+cc_result File_Rename(const cc_string* src, const cc_string* dst) {
+	char srcStr[NATIVE_STR_LEN], dstStr[NATIVE_STR_LEN];
+	GetNativePath(srcStr, src);
+	GetNativePath(dstStr, dst);
+	return rename(srcStr, dstStr) == -1 ? errno : 0;
+}
 
 cc_result File_Read(cc_file file, void* data, cc_uint32 count, cc_uint32* bytesRead) {
 	*bytesRead = read(file, data, count);
@@ -181,6 +181,10 @@ cc_result File_Create(cc_file* file, const cc_string* path) {
 cc_result File_OpenOrCreate(cc_file* file, const cc_string* path) {
 	return File_Do(file, path, SYS_O_RDWR | SYS_O_CREAT);
 }
+cc_bool File_RenameSupported = false;
+cc_result File_Rename(const cc_string* src, const cc_string* dst) {
+	return ERR_NOT_SUPPORTED;
+}
 
 cc_result File_Read(cc_file file, void* data, cc_uint32 count, cc_uint32* bytesRead) {
 	u64 read = 0;
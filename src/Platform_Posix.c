@@ -276,6 +276,13 @@ cc_result File_Create(cc_file* file, const cc_string* path) {
 cc_result File_OpenOrCreate(cc_file* file, const cc_string* path) {
 	return File_Do(file, path, O_RDWR | O_CREAT);
 }
+cc_bool File_RenameSupported = true;
+cc_result File_Rename(const cc_string* src, const cc_string* dst) {
+	char srcStr[NATIVE_STR_LEN], dstStr[NATIVE_STR_LEN];
+	String_EncodeUtf8(srcStr, src);
+	String_EncodeUtf8(dstStr, dst);
+	return rename(srcStr, dstStr) == -1 ? errno : 0;
+}
 
 cc_result File_Read(cc_file file, void* data, cc_uint32 count, cc_uint32* bytesRead) {
 	*bytesRead = read(file, data, count);
@@ -337,7 +344,16 @@ void* Thread_Create(Thread_StartFunc func) {
 
 void Thread_Start2(void* handle, Thread_StartFunc func) {
 	pthread_t* ptr = (pthread_t*)handle;
-	int res = pthread_create(ptr, NULL, ExecThread, (void*)func);
+	pthread_attr_t attrs;
+	int res;
+
+	/* Default stack size for threads can be quite small (e.g. 512 KB on macOS), */
+	/*  which isn't enough for worker threads that decode .png files */
+	pthread_attr_init(&attrs);
+	pthread_attr_setstacksize(&attrs, 2 * 1024 * 1024);
+
+	res = pthread_create(ptr, &attrs, ExecThread, (void*)func);
+	pthread_attr_destroy(&attrs);
 	if (res) Logger_Abort2(res, "Creating thread");
 }
 
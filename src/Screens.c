@@ -1886,39 +1886,57 @@ static void GeneratingScreen_AtlasChanged(void* obj) {
 	LoadingScreen.dirty = true; /* Dirt texture may have changed */
 }
 
+static void* gen_thread;
+
 static void GeneratingScreen_Init(void* screen) {
-	void* thread;
-	Gen_Done = false;
+	Thread_StartFunc func = Gen_Vanilla ? NotchyGen_Generate : FlatgrassGen_Generate;
+	Gen_Done      = false;
+	Gen_Cancelled = false;
 	LoadingScreen_Init(screen);
 
 	Gen_Blocks = (BlockRaw*)Mem_TryAlloc(World.Volume, 1);
 	if (!Gen_Blocks) {
 		Window_ShowDialog("Out of memory", "Not enough free memory to generate a map that large.\nTry a smaller size.");
 		Gen_Done = true;
-	} else if (Gen_Vanilla) {
-		//thread = Thread_Create(NotchyGen_Generate);
-		//Thread_Start2(thread,  NotchyGen_Generate);
-		//Thread_Detach(thread);
-		NotchyGen_Generate();
 	} else {
-		//thread = Thread_Create(FlatgrassGen_Generate);
-		//Thread_Start2(thread,  FlatgrassGen_Generate);
-		//Thread_Detach(thread);
-		FlatgrassGen_Generate();
+		/* Generate on a background thread, so the screen can still show progress meanwhile */
+		gen_thread = Thread_Create(func);
+		Thread_Start2(gen_thread, func);
 	}
 	Event_Register_(&TextureEvents.AtlasChanged,   NULL, GeneratingScreen_AtlasChanged);
 }
+
+static void GeneratingScreen_JoinThread(void) {
+	if (!gen_thread) return;
+	Thread_Join(gen_thread);
+	gen_thread = NULL;
+}
+
 static void GeneratingScreen_Free(void* screen) {
+	/* Screen was closed before the map finished generating (e.g. game closing) */
+	if (Gen_Blocks) {
+		Gen_Cancelled = true;
+		GeneratingScreen_JoinThread();
+
+		Mem_Free(Gen_Blocks);
+		Gen_Blocks = NULL;
+		Gen_Done   = false;
+	}
+
 	LoadingScreen_Free(screen);
 	Event_Unregister_(&TextureEvents.AtlasChanged, NULL, GeneratingScreen_AtlasChanged);
 }
 
 static void GeneratingScreen_EndGeneration(void) {
-	Gen_Done   = false;
-	World_SetNewMap(Gen_Blocks, World.Width, World.Height, World.Length);
-	if (!Gen_Blocks) { Chat_AddRaw("&cFailed to generate the map."); return; }
+	BlockRaw* blocks = Gen_Blocks;
+	GeneratingScreen_JoinThread();
 
+	/* World takes ownership of the blocks (and this screen gets removed) */
+	Gen_Done   = false;
 	Gen_Blocks = NULL;
+	World_SetNewMap(blocks, World.Width, World.Height, World.Length);
+	if (!blocks) { Chat_AddRaw("&cFailed to generate the map."); return; }
+
 	World.Seed = Gen_Seed;
 
 	LocalPlayer_CalcDefaultSpawn();
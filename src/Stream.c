@@ -293,6 +293,14 @@ static cc_result Stream_BufferedRead(struct Stream* s, cc_uint8* data, cc_uint32
 		source               = s->Meta.Buffered.Source; 
 		s->Meta.Buffered.Cur = s->Meta.Buffered.Base;
 
+		/* Large reads go directly into the destination, avoiding a pointless copy */
+		if (count >= s->Meta.Buffered.Length) {
+			res = source->Read(source, data, count, modified);
+			if (res) return res;
+			s->Meta.Buffered.End += *modified;
+			return 0;
+		}
+
 		res = source->Read(source, s->Meta.Buffered.Cur, s->Meta.Buffered.Length, &read);
 		if (res) return res;
 		s->Meta.Buffered.Left  = read;
@@ -363,13 +371,7 @@ void Stream_ReadonlyBuffered(struct Stream* s, struct Stream* source, void* data
 *#########################################################################################################################*/
 static cc_result Stream_Crc32Write(struct Stream* stream, const cc_uint8* data, cc_uint32 count, cc_uint32* modified) {
 	struct Stream* source;
-	cc_uint32 i, crc32 = stream->Meta.CRC32.CRC32;
-
-	/* TODO: Optimise this calculation */
-	for (i = 0; i < count; i++) {
-		crc32 = Utils_Crc32Table[(crc32 ^ data[i]) & 0xFF] ^ (crc32 >> 8);
-	}
-	stream->Meta.CRC32.CRC32 = crc32;
+	stream->Meta.CRC32.CRC32 = Utils_UpdateCRC32(stream->Meta.CRC32.CRC32, data, count);
 
 	source = stream->Meta.CRC32.Source;
 	return source->Write(source, data, count, modified);
@@ -31,6 +31,7 @@ struct Stream {
 	union {
 		cc_file File;
 		void* Inflate;
+		struct { void* State; void* Tables; } Deflate; /* NOTE: State is the same as Inflate */
 		struct { cc_uint8* Cur; cc_uint32 Left, Length; cc_uint8* Base; } Mem;
 		struct { struct Stream* Source; cc_uint32 Left, Length; } Portion;
 		struct { cc_uint8* Cur; cc_uint32 Left, Length; cc_uint8* Base; struct Stream* Source; cc_uint32 End; } Buffered;
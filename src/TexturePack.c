@@ -177,11 +177,12 @@ cc_bool Atlas_TryChange(struct Bitmap* atlas) {
 /*########################################################################################################################*
 *------------------------------------------------------TextureCache-------------------------------------------------------*
 *#########################################################################################################################*/
-static struct StringsBuffer acceptedList, deniedList, etagCache, lastModCache;
+static struct StringsBuffer acceptedList, deniedList, etagCache, lastModCache, decodedList;
 #define ACCEPTED_TXT "texturecache/acceptedurls.txt"
 #define DENIED_TXT   "texturecache/deniedurls.txt"
 #define ETAGS_TXT    "texturecache/etags.txt"
 #define LASTMOD_TXT  "texturecache/lastmodified.txt"
+#define DECODED_TXT  "texturecache/decodedpacks.txt"
 
 /* Initialises cache state (loading various lists) */
 static void TextureCache_Init(void) {
@@ -189,6 +190,7 @@ static void TextureCache_Init(void) {
 	EntryList_UNSAFE_Load(&deniedList,   DENIED_TXT);
 	EntryList_UNSAFE_Load(&etagCache,    ETAGS_TXT);
 	EntryList_UNSAFE_Load(&lastModCache, LASTMOD_TXT);
+	EntryList_UNSAFE_Load(&decodedList,  DECODED_TXT);
 }
 
 cc_bool TextureCache_HasAccepted(const cc_string* url) { return EntryList_Find(&acceptedList, url, ' ') >= 0; }
@@ -323,6 +325,372 @@ static void UpdateCache(struct HttpRequest* req) {
 }
 
 
+/*########################################################################################################################*
+*----------------------------------------------------Texture entries------------------------------------------------------*
+*#########################################################################################################################*/
+static struct TextureEntry* entries_head;
+static struct TextureEntry* entries_tail;
+
+void TextureEntry_Register(struct TextureEntry* entry) {
+	LinkedList_Append(entry, entries_head, entries_tail);
+}
+
+static struct TextureEntry* TextureEntry_Find(const cc_string* name) {
+	struct TextureEntry* e;
+
+	for (e = entries_head; e; e = e->next) {
+		if (String_CaselessEqualsConst(name, e->filename)) return e;
+	}
+	return NULL;
+}
+
+cc_result TextureEntry_DecodePng(struct Bitmap* bmp, struct Stream* stream, struct Bitmap* decoded) {
+	if (!decoded || !decoded->scan0) return Png_Decode(bmp, stream);
+
+	/* Pixels can only be taken once */
+	*bmp = *decoded;
+	decoded->scan0 = NULL;
+	return 0;
+}
+
+/* Name of the file whose TextureEntry was already called by TexturePack_ProcessFile, see OnFileChanged */
+static const cc_string* processedFile;
+
+/* Processes a file in a texture pack, decoded is the .png file already decoded ahead of time or NULL */
+static void TexturePack_ProcessFile(struct Stream* stream, const cc_string* name, struct Bitmap* decoded) {
+	struct TextureEntry* e = TextureEntry_Find(name);
+	if (e) e->Callback(stream, name, decoded);
+
+	/* Other files (e.g. model skins) are processed by event handlers */
+	processedFile = name;
+	Event_RaiseEntry(&TextureEvents.FileChanged, stream, name);
+	processedFile = NULL;
+}
+
+/* Files may also be changed by raising TextureEvents.FileChanged elsewhere (e.g. by plugins) */
+static void OnFileChanged(void* obj, struct Stream* stream, const cc_string* name) {
+	struct TextureEntry* e;
+	if (processedFile && String_CaselessEquals(name, processedFile)) return;
+
+	e = TextureEntry_Find(name);
+	if (e) e->Callback(stream, name, NULL);
+}
+
+
+/*########################################################################################################################*
+*---------------------------------------------------Decoded pack cache----------------------------------------------------*
+*#########################################################################################################################*/
+/* Stores the already decoded entries of a texture pack .zip, so that loading the same .zip again */
+/*  only has to read in the pixels of each .png, instead of inflating and decoding them all again */
+/* Layout is a header, then for each entry: name length, size, width, height, name, file data, pixels */
+/* NOTE: File data is stored too, since TextureEvents.FileChanged handlers (e.g. plugins) may read it */
+#define DECODED_MAGIC   0x50544343UL /* "CCTP" */
+#define DECODED_VERSION 2
+#define DECODED_HEADER_SIZE 24
+#define DECODED_ENTRY_SIZE  16
+/* Only the most recently used packs are kept, since decoded packs take up a lot of space */
+#define DECODED_MAX_PACKS 4
+
+#if defined CC_BUILD_LOWMEM || defined CC_BUILD_WEB
+/* Decoded packs are several times larger than the .zip, which isn't worth it when storage is tight */
+#define DECODED_CACHE_ENABLED false
+#else
+#define DECODED_CACHE_ENABLED true
+#endif
+
+static struct DecodedCacheState {
+	struct Stream stream;
+	cc_bool writing;  /* Whether entries are currently being written to the cache */
+	cc_uint32 crc32, length, count;
+	int slot;         /* Index of the cache file being written */
+	int skip;         /* Number of entries already processed from the cache, before reading it failed */
+	cc_string key; char keyBuffer[STRING_SIZE];
+} decodedCache;
+
+/* Calculates the key identifying the contents of the given .zip archive */
+static cc_result DecodedCache_MakeKey(struct Stream* stream) {
+	cc_uint8 buffer[16384];
+	cc_uint32 crc32 = 0xFFFFFFFFUL, length = 0, read;
+	cc_result res;
+
+	if ((res = stream->Seek(stream, 0))) return res;
+	for (;;) {
+		if ((res = stream->Read(stream, buffer, sizeof(buffer), &read))) return res;
+		if (!read) break;
+
+		crc32   = Utils_UpdateCRC32(crc32, buffer, read);
+		length += read;
+	}
+
+	decodedCache.crc32  = crc32 ^ 0xFFFFFFFFUL;
+	decodedCache.length = length;
+	String_InitArray(decodedCache.key, decodedCache.keyBuffer);
+	String_Format2(&decodedCache.key, "%h:%h", &decodedCache.crc32, &decodedCache.length);
+	return stream->Seek(stream, 0);
+}
+
+static void DecodedCache_MakePath(cc_string* path, int slot) {
+	String_Format1(path, "texturecache/decoded%i", &slot);
+}
+
+static int DecodedCache_GetSlot(const cc_string* entry) {
+	cc_string key, value;
+	int slot;
+
+	String_UNSAFE_Separate(entry, ' ', &key, &value);
+	if (!Convert_ParseInt(&value, &slot)) return -1;
+	return slot >= 0 && slot < DECODED_MAX_PACKS ? slot : -1;
+}
+
+/* Returns the index of the cache file for the current key, or -1 if not cached */
+static int DecodedCache_FindSlot(void) {
+	cc_string entry;
+	int i = EntryList_Find(&decodedList, &decodedCache.key, ' ');
+	if (i == -1) return -1;
+
+	entry = StringsBuffer_UNSAFE_Get(&decodedList, i);
+	return DecodedCache_GetSlot(&entry);
+}
+
+/* Removes all the packs that are stored in the given cache file from the list */
+static void DecodedCache_FreeSlot(int slot) {
+	cc_string entry;
+	int i;
+
+	for (i = decodedList.count - 1; i >= 0; i--) {
+		entry = StringsBuffer_UNSAFE_Get(&decodedList, i);
+		if (DecodedCache_GetSlot(&entry) == slot) StringsBuffer_Remove(&decodedList, i);
+	}
+}
+
+/* Returns an unused cache file, or otherwise the cache file of the least recently used pack */
+static int DecodedCache_NewSlot(void) {
+	cc_bool used[DECODED_MAX_PACKS];
+	cc_string entry;
+	int i, slot, lru = -1;
+	for (i = 0; i < DECODED_MAX_PACKS; i++) used[i] = false;
+
+	/* NOTE: Most recently used packs are at the end of the list */
+	for (i = 0; i < decodedList.count; i++) {
+		entry = StringsBuffer_UNSAFE_Get(&decodedList, i);
+		slot  = DecodedCache_GetSlot(&entry);
+
+		if (slot == -1) continue;
+		if (lru  == -1) lru = slot;
+		used[slot] = true;
+	}
+
+	for (i = 0; i < DECODED_MAX_PACKS; i++) {
+		if (!used[i]) return i;
+	}
+	return lru;
+}
+
+/* Moves the current key to the end of the list, as it is now the most recently used pack */
+static void DecodedCache_MarkUsed(int slot) {
+	cc_string value; char valueBuffer[STRING_INT_CHARS];
+	String_InitArray(value, valueBuffer);
+	String_AppendInt(&value, slot);
+
+	EntryList_Set(&decodedList, &decodedCache.key, &value, ' ');
+	EntryList_Save(&decodedList, DECODED_TXT);
+}
+
+static void DecodedCache_MakeHeader(cc_uint8* header, cc_uint32 magic, cc_uint32 count) {
+	Stream_SetU32_LE(&header[0],  magic);
+	Stream_SetU32_LE(&header[4],  DECODED_VERSION);
+	/* Pixels are stored in the platform's BitmapCol layout */
+	Stream_SetU32_LE(&header[8],  BitmapCol_Make(1, 2, 3, 4));
+	Stream_SetU32_LE(&header[12], decodedCache.crc32);
+	Stream_SetU32_LE(&header[16], decodedCache.length);
+	Stream_SetU32_LE(&header[20], count);
+}
+
+/* Checks that the header and the sizes of all entries are valid, and add up to the length of the file */
+/* NOTE: Otherwise reading an incomplete or corrupted cache would fail partway through processing the entries */
+static cc_result DecodedCache_Check(struct Stream* file, cc_uint32* count) {
+	cc_uint8 header[DECODED_HEADER_SIZE], expected[DECODED_HEADER_SIZE];
+	cc_uint32 i, pos, length, nameLen, size, width, height;
+	cc_result res;
+
+	if ((res = file->Length(file, &length)))                  return res;
+	if ((res = Stream_Read(file, header, DECODED_HEADER_SIZE))) return res;
+
+	*count = Stream_GetU32_LE(&header[20]);
+	DecodedCache_MakeHeader(expected, DECODED_MAGIC, *count);
+	if (!Mem_Equal(header, expected, DECODED_HEADER_SIZE)) return ERR_INVALID_ARGUMENT;
+
+	for (i = 0, pos = DECODED_HEADER_SIZE; i < *count; i++) {
+		if (length - pos < DECODED_ENTRY_SIZE) return ERR_END_OF_STREAM;
+		if ((res = file->Seek(file, pos)))                         return res;
+		if ((res = Stream_Read(file, header, DECODED_ENTRY_SIZE))) return res;
+		pos += DECODED_ENTRY_SIZE;
+
+		nameLen = Stream_GetU16_LE(&header[0]);
+		size    = Stream_GetU32_LE(&header[4]);
+		width   = Stream_GetU32_LE(&header[8]);
+		height  = Stream_GetU32_LE(&header[12]);
+
+		if (nameLen > FILENAME_SIZE)                            return ERR_INVALID_ARGUMENT;
+		if (width > PNG_MAX_DIMS || height > PNG_MAX_DIMS)      return ERR_INVALID_ARGUMENT;
+		if (length - pos < nameLen)                             return ERR_END_OF_STREAM;
+		pos += nameLen;
+		if (length - pos < size)                                return ERR_END_OF_STREAM;
+		pos += size;
+		if ((length - pos) / 4 < width * height)                return ERR_END_OF_STREAM;
+		pos += width * height * 4;
+	}
+
+	if (pos != length) return ERR_INVALID_ARGUMENT;
+	return file->Seek(file, DECODED_HEADER_SIZE);
+}
+
+static cc_result DecodedCache_ReadEntry(struct Stream* s) {
+	cc_string name; char nameBuffer[FILENAME_SIZE];
+	cc_uint8 header[DECODED_ENTRY_SIZE];
+	struct Stream data;
+	struct Bitmap bmp;
+	cc_uint8* buffer;
+	cc_uint32 size;
+	cc_result res;
+
+	if ((res = Stream_Read(s, header, DECODED_ENTRY_SIZE))) return res;
+	name = String_Init(nameBuffer, Stream_GetU16_LE(&header[0]), FILENAME_SIZE);
+	if ((res = Stream_Read(s, (cc_uint8*)nameBuffer, name.length))) return res;
+
+	size   = Stream_GetU32_LE(&header[4]);
+	buffer = (cc_uint8*)Mem_TryAlloc(size + 1, 1);
+	if (!buffer) return ERR_OUT_OF_MEMORY;
+	if ((res = Stream_Read(s, buffer, size))) { Mem_Free(buffer); return res; }
+
+	bmp.width  = Stream_GetU32_LE(&header[8]);
+	bmp.height = Stream_GetU32_LE(&header[12]);
+	bmp.scan0  = NULL;
+
+	if (bmp.width && bmp.height) {
+		bmp.scan0 = (BitmapCol*)Mem_TryAlloc(bmp.width * bmp.height, 4);
+		if (!bmp.scan0) res = ERR_OUT_OF_MEMORY;
+		else res = Stream_Read(s, (cc_uint8*)bmp.scan0, bmp.width * bmp.height * 4);
+	}
+
+	if (!res) {
+		/* Same as for a .png that was decoded ahead of time, see ProcessZipEntry */
+		Stream_ReadonlyMemory(&data, buffer, size);
+		TexturePack_ProcessFile(&data, &name, bmp.scan0 ? &bmp : NULL);
+	}
+
+	/* Pixels are NULL if taken while processing */
+	Mem_Free(bmp.scan0);
+	Mem_Free(buffer);
+	return res;
+}
+
+/* Attempts to process all the entries stored in the cache for the current key */
+/* NOTE: If reading fails after some entries were processed, decodedCache.skip is set to the number processed */
+static cc_bool DecodedCache_Load(void) {
+	cc_string path; char pathBuffer[FILENAME_SIZE];
+	cc_uint8 buffer[16384];
+	struct Stream file, stream;
+	cc_uint32 i, count;
+	cc_result res;
+	int slot;
+
+	decodedCache.skip = 0;
+	slot = DecodedCache_FindSlot();
+	if (slot == -1) return false;
+
+	String_InitArray(path, pathBuffer);
+	DecodedCache_MakePath(&path, slot);
+	if (Stream_OpenFile(&file, &path)) return false;
+
+	/* Incomplete or outdated cache just gets written again */
+	res = DecodedCache_Check(&file, &count);
+	Stream_ReadonlyBuffered(&stream, &file, buffer, sizeof(buffer));
+
+	for (i = 0; !res && i < count; i++) {
+		if ((res = DecodedCache_ReadEntry(&stream))) break;
+	}
+
+	/* No point logging error for closing readonly file */
+	(void)file.Close(&file);
+
+	if (!res) { DecodedCache_MarkUsed(slot); return true; }
+	if (i) Logger_SysWarn2(res, "reading cache for", &decodedCache.key);
+
+	decodedCache.skip = i;
+	return false;
+}
+
+static void DecodedCache_Begin(void) {
+	cc_string path; char pathBuffer[FILENAME_SIZE];
+	cc_uint8 header[DECODED_HEADER_SIZE];
+	cc_result res;
+	int slot;
+
+	/* Remove whichever pack was previously stored in the cache file first */
+	slot = DecodedCache_FindSlot();
+	if (slot == -1) slot = DecodedCache_NewSlot();
+	DecodedCache_FreeSlot(slot);
+	EntryList_Save(&decodedList, DECODED_TXT);
+
+	String_InitArray(path, pathBuffer);
+	DecodedCache_MakePath(&path, slot);
+	res = Stream_CreateFile(&decodedCache.stream, &path);
+	if (res) { Logger_SysWarn2(res, "creating cache for", &decodedCache.key); return; }
+
+	/* Magic is only written once all the entries have been, see DecodedCache_End */
+	DecodedCache_MakeHeader(header, 0, 0);
+	res = Stream_Write(&decodedCache.stream, header, DECODED_HEADER_SIZE);
+	if (res) { (void)decodedCache.stream.Close(&decodedCache.stream); return; }
+
+	decodedCache.writing = true;
+	decodedCache.count   = 0;
+	decodedCache.slot    = slot;
+}
+
+static void DecodedCache_Write(const cc_string* name, const cc_uint8* data, cc_uint32 size, struct Bitmap* bmp) {
+	cc_uint8 header[DECODED_ENTRY_SIZE];
+	cc_result res;
+	if (!decodedCache.writing) return;
+
+	Stream_SetU16_LE(&header[0],  name->length);
+	Stream_SetU16_LE(&header[2],  0);
+	Stream_SetU32_LE(&header[4],  size);
+	Stream_SetU32_LE(&header[8],  bmp ? bmp->width  : 0);
+	Stream_SetU32_LE(&header[12], bmp ? bmp->height : 0);
+
+	res = Stream_Write(&decodedCache.stream, header, DECODED_ENTRY_SIZE);
+	if (!res) res = Stream_Write(&decodedCache.stream, (const cc_uint8*)name->buffer, name->length);
+	if (!res) res = Stream_Write(&decodedCache.stream, data, size);
+	if (!res && bmp) res = Stream_Write(&decodedCache.stream, (const cc_uint8*)bmp->scan0, bmp->width * bmp->height * 4);
+
+	if (res) {
+		/* Magic never gets written, so the incomplete cache is ignored */
+		(void)decodedCache.stream.Close(&decodedCache.stream);
+		decodedCache.writing = false;
+	} else {
+		decodedCache.count++;
+	}
+}
+
+static void DecodedCache_End(cc_bool success) {
+	cc_uint8 header[DECODED_HEADER_SIZE];
+	cc_result res = 0, closeRes;
+	if (!decodedCache.writing) return;
+	decodedCache.writing = false;
+
+	if (success) {
+		DecodedCache_MakeHeader(header, DECODED_MAGIC, decodedCache.count);
+		res = decodedCache.stream.Seek(&decodedCache.stream, 0);
+		if (!res) res = Stream_Write(&decodedCache.stream, header, DECODED_HEADER_SIZE);
+	}
+
+	closeRes = decodedCache.stream.Close(&decodedCache.stream);
+	/* Cache is only used once it has been completely written */
+	if (success && !res && !closeRes) DecodedCache_MarkUsed(decodedCache.slot);
+}
+
+
 /*########################################################################################################################*
 *-------------------------------------------------------TexturePack-------------------------------------------------------*
 *#########################################################################################################################*/
@@ -361,12 +729,104 @@ cc_result TexturePack_ExtractDefault(DefaultZipCallback callback) {
 
 static cc_bool SelectZipEntry(const cc_string* path) { return true; }
 static cc_result ProcessZipEntry(const cc_string* path, struct Stream* stream, struct ZipEntry* source) {
+	struct Bitmap* bmp = (struct Bitmap*)source->Decoded;
+	cc_uint32 size     = source->UncompressedSize;
+	cc_uint8* buffer   = NULL;
+	struct Stream data;
 	cc_string name = *path;
+	cc_result res;
 	Utils_UNSAFE_GetFilename(&name);
-	Event_RaiseEntry(&TextureEvents.FileChanged, stream, &name);
+
+	/* Entries were already processed from the cache before reading it failed, see DecodedCache_Load */
+	if (decodedCache.skip) { decodedCache.skip--; return 0; }
+
+	if (decodedCache.writing) {
+		/* File data has to be read into memory first, to be stored in the cache */
+		buffer = (cc_uint8*)Mem_TryAlloc(size + 1, 1);
+		if (!buffer) { DecodedCache_End(false); }
+	}
+
+	if (buffer) {
+		if ((res = Stream_Read(stream, buffer, size))) { Mem_Free(buffer); return res; }
+		DecodedCache_Write(&name, buffer, size, bmp);
+
+		Stream_ReadonlyMemory(&data, buffer, size);
+		stream = &data;
+	}
+
+	/* .png may have been decoded on another thread already, see DecodeZipEntry */
+	TexturePack_ProcessFile(stream, &name, bmp);
+
+	Mem_Free(buffer);
 	return 0;
 }
 
+/* Maximum number of pixels in .png files that have been decoded ahead of time, but not processed yet */
+/* (on top of the .zip archive itself, which is also entirely read into memory) */
+#define DECODE_AHEAD_MAX_PIXELS (8 * 1024 * 1024)
+static void* decodeAheadMutex;
+static cc_uint32 decodeAheadPixels;
+
+static cc_bool DecodeAhead_Reserve(cc_uint32 pixels) {
+	cc_bool reserved;
+	Mutex_Lock(decodeAheadMutex);
+	{
+		/* Always allow at least one, otherwise very large .png files would never be decoded ahead of time */
+		reserved = !decodeAheadPixels || decodeAheadPixels + pixels <= DECODE_AHEAD_MAX_PIXELS;
+		if (reserved) decodeAheadPixels += pixels;
+	}
+	Mutex_Unlock(decodeAheadMutex);
+	return reserved;
+}
+
+static void DecodeAhead_Release(cc_uint32 pixels) {
+	Mutex_Lock(decodeAheadMutex);
+	{
+		decodeAheadPixels -= pixels;
+	}
+	Mutex_Unlock(decodeAheadMutex);
+}
+
+/* Decodes .png files ahead of time, since decoding is usually most of the time spent extracting */
+/* NOTE: The TextureEntry list is only ever changed on the main thread before extracting, so reading it here is fine */
+static void* DecodeZipEntry(const cc_string* path, struct Stream* stream) {
+	static const cc_string png = String_FromConst(".png");
+	cc_uint8 header[PNG_SIG_SIZE + 16];
+	cc_uint32 width, height;
+	cc_string name = *path;
+	struct Bitmap* bmp;
+	Utils_UNSAFE_GetFilename(&name);
+
+	/* Only files processed by a TextureEntry are given the decoded bitmap, see TexturePack_ProcessFile */
+	if (!decodeAheadMutex || !String_CaselessEnds(&name, &png) || !TextureEntry_Find(&name)) return NULL;
+
+	/* Check the size in the IHDR chunk first, to limit how many pixels are held in memory at once */
+	if (Stream_Read(stream, header, sizeof(header)) || !Png_Detect(header, PNG_SIG_SIZE)) return NULL;
+	width  = Stream_GetU32_BE(&header[PNG_SIG_SIZE + 8]);
+	height = Stream_GetU32_BE(&header[PNG_SIG_SIZE + 12]);
+
+	if (width > PNG_MAX_DIMS || height > PNG_MAX_DIMS) return NULL;
+	if (stream->Seek(stream, 0)) return NULL;
+	if (!DecodeAhead_Reserve(width * height)) return NULL;
+
+	bmp = (struct Bitmap*)Mem_TryAlloc(1, sizeof(struct Bitmap));
+	if (bmp && !Png_Decode(bmp, stream)) return bmp;
+
+	/* Error is reported when the file is decoded again while processing */
+	DecodeAhead_Release(width * height);
+	if (bmp) Mem_Free(bmp->scan0);
+	Mem_Free(bmp);
+	return NULL;
+}
+
+static void FreeZipEntry(void* decoded) {
+	struct Bitmap* bmp = (struct Bitmap*)decoded;
+	DecodeAhead_Release(bmp->width * bmp->height);
+	/* Pixels are NULL if taken while processing */
+	Mem_Free(bmp->scan0);
+	Mem_Free(bmp);
+}
+
 static cc_result ExtractPng(struct Stream* stream) {
 	struct Bitmap bmp;
 	cc_result res = Png_Decode(&bmp, stream);
@@ -376,6 +836,22 @@ static cc_result ExtractPng(struct Stream* stream) {
 	return res;
 }
 
+static cc_result ExtractZip(struct Stream* stream, const cc_string* path) {
+	cc_result res;
+
+	/* Reuse the decoded entries from the last time this .zip was extracted */
+	if (DECODED_CACHE_ENABLED && !DecodedCache_MakeKey(stream)) {
+		if (DecodedCache_Load()) return 0;
+		/* Cache can't be written again when some entries are skipped */
+		if (!decodedCache.skip) DecodedCache_Begin();
+	}
+
+	res = Zip_ExtractParallel(stream, SelectZipEntry, ProcessZipEntry, DecodeZipEntry, FreeZipEntry);
+	DecodedCache_End(res == 0);
+	decodedCache.skip = 0;
+	return res;
+}
+
 static cc_bool needReload;
 static cc_result ExtractFrom(struct Stream* stream, const cc_string* path) {
 	cc_result res;
@@ -389,7 +865,7 @@ static cc_result ExtractFrom(struct Stream* stream, const cc_string* path) {
 	res = ExtractPng(stream);
 	if (res == PNG_ERR_INVALID_SIG) {
 		/* file isn't a .png image, probably a .zip archive then */
-		res = Zip_Extract(stream, SelectZipEntry, ProcessZipEntry);
+		res = ExtractZip(stream, path);
 
 		if (res) Logger_SysWarn2(res, "extracting", path);
 	} else if (res) {
@@ -469,20 +945,13 @@ void TexturePack_Extract(const cc_string* url) {
 	TexturePack_ExtractCurrent(false);
 }
 
-static struct TextureEntry* entries_head;
-static struct TextureEntry* entries_tail;
-
-void TextureEntry_Register(struct TextureEntry* entry) {
-	LinkedList_Append(entry, entries_head, entries_tail);
-}
-
 
 /*########################################################################################################################*
 *---------------------------------------------------Textures component----------------------------------------------------*
 *#########################################################################################################################*/
-static void TerrainPngProcess(struct Stream* stream, const cc_string* name) {
+static void TerrainPngProcess(struct Stream* stream, const cc_string* name, struct Bitmap* decoded) {
 	struct Bitmap bmp;
-	cc_result res = Png_Decode(&bmp, stream);
+	cc_result res = TextureEntry_DecodePng(&bmp, stream, decoded);
 
 	if (res) {
 		Logger_SysWarn2(res, "decoding", name);
@@ -494,17 +963,6 @@ static void TerrainPngProcess(struct Stream* stream, const cc_string* name) {
 static struct TextureEntry terrain_entry = { "terrain.png", TerrainPngProcess };
 
 
-static void OnFileChanged(void* obj, struct Stream* stream, const cc_string* name) {
-	struct TextureEntry* e;
-
-	for (e = entries_head; e; e = e->next) {
-		if (!String_CaselessEqualsConst(name, e->filename)) continue;
-
-		e->Callback(stream, name);
-		return;
-	}
-}
-
 static void OnContextLost(void* obj) {
 	if (!Gfx.ManagedTextures) Atlas1D_Free();
 }
@@ -535,6 +993,7 @@ static void OnInit(void) {
 	Utils_EnsureDirectory("texpacks");
 	Utils_EnsureDirectory("texturecache");
 	TextureCache_Init();
+	decodeAheadMutex = Mutex_Create();
 }
 
 static void OnReset(void) {
@@ -548,6 +1007,9 @@ static void OnFree(void) {
 	Atlas2D_Free();
 	TexturePack_Url.length = 0;
 	entries_head = NULL;
+
+	Mutex_Free(decodeAheadMutex);
+	decodeAheadMutex = NULL;
 }
 
 struct IGameComponent Textures_Component = {
@@ -108,8 +108,11 @@ cc_result TexturePack_ExtractDefault(DefaultZipCallback callback);
 struct TextureEntry;
 struct TextureEntry {
 	const char* filename;
-	void (*Callback)(struct Stream* stream, const cc_string* name);
+	/* decoded is the .png file already decoded ahead of time (e.g. on another thread), or NULL */
+	void (*Callback)(struct Stream* stream, const cc_string* name, struct Bitmap* decoded);
 	struct TextureEntry* next;
 };
 void TextureEntry_Register(struct TextureEntry* entry);
+/* Takes ownership of the pixels in decoded if it is non-NULL, otherwise decodes the .png from the stream */
+cc_result TextureEntry_DecodePng(struct Bitmap* bmp, struct Stream* stream, struct Bitmap* decoded);
 #endif
@@ -8,6 +8,8 @@ Copyright 2014-2023 ClassiCube | Licensed under BSD-3
 
 struct Bitmap;
 struct StringsBuffer;
+struct IGameComponent;
+extern struct IGameComponent Parallel_Component;
 /* Represents a particular instance in time in some timezone. Not necessarily UTC time. */
 /* NOTE: TimeMS and DateTime_CurrentUTC_MS() should almost always be used instead. */
 /* This struct should only be used when actually needed. (e.g. log message time) */
@@ -40,10 +42,22 @@ int Utils_AccumulateWheelDelta(float* accumulator, float delta);
 #define Utils_AdjViewDist(value) ((int)(1.4142135f * (value)))
 
 cc_uint8 Utils_CalcSkinType(const struct Bitmap* bmp);
+/* Calculates the CRC32 of the given data. */
 cc_uint32 Utils_CRC32(const cc_uint8* data, cc_uint32 length);
+/* Updates a running CRC32 with the given data. */
+/* NOTE: Running CRC32 starts as 0xFFFFFFFF, and must be xor-ed with 0xFFFFFFFF to get the final CRC32 */
+cc_uint32 Utils_UpdateCRC32(cc_uint32 crc, const cc_uint8* data, cc_uint32 length);
+/* Updates a running Adler32 (which starts as 1) with the given data. */
+cc_uint32 Utils_UpdateAdler32(cc_uint32 adler, const cc_uint8* data, cc_uint32 length);
 /* CRC32 lookup table, for faster CRC32 calculations. */
 /* NOTE: This cannot be just indexed by byte value - see Utils_CRC32 implementation. */
 extern const cc_uint32 Utils_Crc32Table[256];
+typedef void (*Utils_ParallelFunc)(void* obj, int index);
+/* Calls func for every index from 0 to count - 1, spread across several threads. */
+/* Returns once all the calls have completed. (order of calls is not defined) */
+/* NOTE: On platforms where threads are unavailable or memory is tight, just runs in order on the calling thread */
+/* NOTE: Also just runs in order when Parallel_Component isn't initialised, or another thread is already using it */
+void Utils_ParallelFor(Utils_ParallelFunc func, void* obj, int count);
 CC_NOINLINE void Utils_Resize(void** buffer, int* capacity, cc_uint32 elemSize, int defCapacity, int expandElems);
 
 /* Converts blocks of 3 bytes into 4 ASCII characters. (pads if needed) */
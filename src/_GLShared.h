@@ -232,26 +232,20 @@ void Gfx_CalcPerspectiveMatrix(struct Matrix* matrix, float fov, float aspect, f
 /*########################################################################################################################*
 *-----------------------------------------------------------Misc----------------------------------------------------------*
 *#########################################################################################################################*/
-static BitmapCol* GL_GetRow(struct Bitmap* bmp, int y) { 
-	/* OpenGL stores bitmap in bottom-up order, so flip order when saving */
-	return Bitmap_GetRow(bmp, (bmp->height - 1) - y); 
-}
-cc_result Gfx_TakeScreenshot(struct Stream* output) {
-	struct Bitmap bmp;
-	cc_result res;
+cc_result Gfx_TakeScreenshot(struct Bitmap* bmp, cc_bool* bottomUp) {
 	GLint vp[4];
 	
 	glGetIntegerv(GL_VIEWPORT, vp); /* { x, y, width, height } */
-	bmp.width  = vp[2]; 
-	bmp.height = vp[3];
+	bmp->width  = vp[2]; 
+	bmp->height = vp[3];
 
-	bmp.scan0  = (BitmapCol*)Mem_TryAlloc(bmp.width * bmp.height, 4);
-	if (!bmp.scan0) return ERR_OUT_OF_MEMORY;
-	glReadPixels(0, 0, bmp.width, bmp.height, PIXEL_FORMAT, TRANSFER_FORMAT, bmp.scan0);
+	bmp->scan0  = (BitmapCol*)Mem_TryAlloc(bmp->width * bmp->height, 4);
+	if (!bmp->scan0) return ERR_OUT_OF_MEMORY;
+	glReadPixels(0, 0, bmp->width, bmp->height, PIXEL_FORMAT, TRANSFER_FORMAT, bmp->scan0);
 
-	res = Png_Encode(&bmp, output, GL_GetRow, false);
-	Mem_Free(bmp.scan0);
-	return res;
+	/* OpenGL stores bitmap in bottom-up order */
+	*bottomUp = true;
+	return 0;
 }
 
 static void AppendVRAMStats(cc_string* info) {